@@ -13,6 +13,45 @@
 #define PWM_BITS_BCKL 8
 #define PWM_MAX_BCKL ((1 << PWM_BITS_BCKL) - 1)
 
+// Defaults for the draw buffers, can be overridden with build flags
+#ifndef LVGL_BUFFER_COUNT
+#define LVGL_BUFFER_COUNT 1
+#endif
+#ifndef LVGL_BUFFER_LINES
+#define LVGL_BUFFER_LINES 0
+#endif
+#ifndef LVGL_RENDER_MODE
+#ifdef SMARTDISPLAY_RGB_DIRECT_MODE
+#define LVGL_RENDER_MODE LV_DISPLAY_RENDER_MODE_DIRECT
+#else
+#define LVGL_RENDER_MODE LV_DISPLAY_RENDER_MODE_PARTIAL
+#endif
+#endif
+
+// Displays that can be brought up, the board display and the ones added with smartdisplay_add_display()
+#ifndef SMARTDISPLAY_MAX_DISPLAYS
+#define SMARTDISPLAY_MAX_DISPLAYS 2
+#endif
+
+// Round displays only show the circle inscribed in the frame memory, the pixels outside of it are not sent
+#ifndef DISPLAY_ROUND
+#ifdef DISPLAY_GC9A01_SPI
+#define DISPLAY_ROUND 1
+#else
+#define DISPLAY_ROUND 0
+#endif
+#endif
+
+// Panels driven by the DCS engine
+#if defined(DISPLAY_ILI9341_SPI) || defined(DISPLAY_ST7789_SPI) || defined(DISPLAY_ST7796_SPI)
+#define SMARTDISPLAY_DCS_PANEL
+#endif
+
+// DCS panels with frame rate control, the ST7796 has none
+#if defined(SMARTDISPLAY_DCS_PANEL) && !defined(DISPLAY_ST7796_SPI)
+#define SMARTDISPLAY_DCS_FRAME_RATE
+#endif
+
 // Exported functions
 #ifdef __cplusplus
 extern "C"
@@ -30,8 +69,66 @@ extern "C"
         float deltaY;
     } touch_calibration_data_t;
 
+    // Orientation of a panel at LV_DISPLAY_ROTATION_0, the other rotations are set with swap_xy and mirror by the panel
+    typedef struct
+    {
+        bool enabled; // False if the flush callback rotates (software rotation)
+        bool swap_xy;
+        bool mirror_x;
+        bool mirror_y;
+    } smartdisplay_hw_rotation_t;
+
+    // Configuration of a display
+    typedef struct
+    {
+        uint8_t buffer_count;                   // Number of draw buffers (1 or 2). With 2, LVGL renders the next band while the previous one is transferred
+        uint32_t buffer_pixels;                 // Size of a draw buffer in pixels
+        uint32_t buffer_lines;                  // Size of a draw buffer in lines, overrides buffer_pixels if not 0
+        lv_display_render_mode_t render_mode;   // LV_DISPLAY_RENDER_MODE_PARTIAL, _DIRECT (RGB panels only) or _FULL
+        uint32_t buffer_malloc_flags;           // Heap capabilities of the draw buffers (MALLOC_CAP_*)
+        uint32_t refresh_period_ms;             // Period of the LVGL refresh timer of the display, 0 for LV_DEF_REFR_PERIOD
+        smartdisplay_hw_rotation_t hw_rotation; // Added displays only, the board display always uses the DISPLAY_SWAP_XY/MIRROR_X/MIRROR_Y flags
+    } smartdisplay_config_t;
+
+#ifdef DISPLAY_SOFTWARE_ROTATION
+#define SMARTDISPLAY_HW_ROTATION_DEFAULT() {.enabled = false}
+#else
+#define SMARTDISPLAY_HW_ROTATION_DEFAULT() {.enabled = true, .swap_xy = DISPLAY_SWAP_XY, .mirror_x = DISPLAY_MIRROR_X, .mirror_y = DISPLAY_MIRROR_Y}
+#endif
+
+// Configuration from the build flags, as used by smartdisplay_init()
+#define SMARTDISPLAY_CONFIG_DEFAULT()                    \
+    {                                                    \
+        .buffer_count = LVGL_BUFFER_COUNT,               \
+        .buffer_pixels = LVGL_BUFFER_PIXELS,             \
+        .buffer_lines = LVGL_BUFFER_LINES,               \
+        .render_mode = LVGL_RENDER_MODE,                 \
+        .buffer_malloc_flags = LVGL_BUFFER_MALLOC_FLAGS, \
+        .refresh_period_ms = LV_DEF_REFR_PERIOD,         \
+        .hw_rotation = SMARTDISPLAY_HW_ROTATION_DEFAULT()}
+
+    // Handle of a display brought up by smartdisplay_init() or smartdisplay_add_display()
+    typedef struct smartdisplay smartdisplay_t;
+    // Initialization of a panel driver, returns the LVGL display with the panel handle as user data (lvgl_lcd_init() for the board display)
+    typedef lv_display_t *(*smartdisplay_lcd_init_cb_t)(const smartdisplay_config_t *config);
+
     // Initialize the display and touch
     void smartdisplay_init();
+    // Initialize the display and touch with a specific draw buffer configuration
+    void smartdisplay_init_with_config(const smartdisplay_config_t *config);
+    // Bring up another display after smartdisplay_init(), NULL on failure. All the displays are refreshed by lv_timer_handler(),
+    // every one at its own refresh period. A panel initialized with smartdisplay_dma_init() gets its own DMA manager (te_sync false).
+    // The extra panel needs its own lcd_init: the library panel drivers, and the RGB panel state, only exist once for the board
+    // display. lvgl_lcd_init() is rejected and smartdisplay_rgb_init() fails for a second RGB panel.
+    // Backlight, touch, power policy, scrolling, capture and TE remain features of the board display
+    smartdisplay_t *smartdisplay_add_display(smartdisplay_lcd_init_cb_t lcd_init, const smartdisplay_config_t *config);
+    // The board display, NULL before smartdisplay_init()
+    smartdisplay_t *smartdisplay_get_default();
+    lv_display_t *smartdisplay_get_lv_display(const smartdisplay_t *smartdisplay);
+    // Set the period of the LVGL refresh timer of a display, 0 for LV_DEF_REFR_PERIOD
+    void smartdisplay_set_refresh_period(smartdisplay_t *smartdisplay, uint32_t period_ms);
+    // Allocate and set the draw buffers of the display, used by the display drivers
+    void smartdisplay_lcd_set_buffers(lv_display_t *display, const smartdisplay_config_t *config);
 #ifdef BOARD_HAS_TOUCH
     // Touch calibration
     extern touch_calibration_data_t touch_calibration_data;
@@ -46,6 +143,52 @@ extern "C"
     // Read CdS sensor and return a value for the screen brightness (to be used in smartdisplay_lcd_set_brightness_cb)
     float smartdisplay_lcd_adaptive_brightness_cds();
 #endif    
+    // Power policy, called with true when nothing has been rendered for idle_ms and with false when rendering starts again
+    typedef void (*smartdisplay_lcd_power_policy_cb_t)(bool idle);
+    void smartdisplay_lcd_set_power_policy_cb(smartdisplay_lcd_power_policy_cb_t cb, uint32_t idle_ms);
+#ifdef SMARTDISPLAY_DCS_PANEL
+    // Power policy for the DCS panels: internal refresh at SMARTDISPLAY_IDLE_FRAME_RATE (not on the ST7796), 8 color idle mode
+    // with SMARTDISPLAY_IDLE_8_COLORS and partial mode on the rows set by smartdisplay_lcd_power_policy_dcs_set_partial_area()
+    void smartdisplay_lcd_power_policy_dcs(bool idle);
+    // Display rows [y, y + height) still refreshed while idle, the others show the background. A height of 0 (default) keeps all the rows.
+    // Partial mode is not available when X and Y are swapped
+    void smartdisplay_lcd_power_policy_dcs_set_partial_area(int y, int height);
+#endif
+    // Scroll the content of a full width object up by dy pixels (down if negative). On panels with hardware scrolling only the
+    // exposed lines are drawn and sent. The object should have a plain background, no vertical border and no scrollbar
+    void smartdisplay_lcd_scroll(lv_obj_t *obj, int32_t dy);
+    // Screenshots, streamed as a smartdisplay_capture_header_t followed by the pixels row by row, top to bottom
+#define SMARTDISPLAY_CAPTURE_MAGIC "SDSS"
+#define SMARTDISPLAY_CAPTURE_VERSION 1
+    typedef enum
+    {
+        SMARTDISPLAY_CAPTURE_RAW, // RGB565 pixels, little endian
+        SMARTDISPLAY_CAPTURE_RLE, // Runs of a uint8_t count - 1 (1 to 256 pixels, may span rows) and a little endian RGB565 color
+    } smartdisplay_capture_format_t;
+    typedef enum
+    {
+        SMARTDISPLAY_CAPTURE_PANEL,    // Frame memory read back from the DCS panels (RAMRD) or framebuffer of the RGB panels
+        SMARTDISPLAY_CAPTURE_RENDERED, // What LVGL has sent to the panel, requires SMARTDISPLAY_SHADOW_FRAMEBUFFER
+    } smartdisplay_capture_source_t;
+    typedef struct __attribute__((packed))
+    {
+        char magic[4];   // SMARTDISPLAY_CAPTURE_MAGIC
+        uint8_t version; // SMARTDISPLAY_CAPTURE_VERSION
+        uint8_t format;  // smartdisplay_capture_format_t
+        uint16_t width;  // Little endian
+        uint16_t height; // Little endian
+    } smartdisplay_capture_header_t;
+    // Called with the next part of the stream, returns false to abort the capture
+    typedef bool (*smartdisplay_capture_write_cb_t)(const void *data, size_t len, void *user_data);
+    // Stream a screenshot without a copy of the frame, only a row is buffered. Call it from the LVGL task.
+    // The DCS panels are read in the display orientation, the RGB panels in the orientation of the framebuffer.
+    // Comparing the PANEL and RENDERED captures shows the flushes that did not reach the panel (round displays only show the circle)
+    esp_err_t smartdisplay_lcd_capture(smartdisplay_capture_source_t source, smartdisplay_capture_format_t format, smartdisplay_capture_write_cb_t write, void *user_data);
+#ifdef DISPLAY_TE
+    // LVGL event sent to the display at the panel refreshes seen by the timer handler, the parameter is a lcd_te_info_t *.
+    // By default the handler sleeps between the refreshes of the display, SMARTDISPLAY_FRAME_SYNC_POLL_MS 1 sees every panel refresh
+    extern uint32_t smartdisplay_event_frame_sync;
+#endif
 #ifdef BOARD_HAS_RGB_LED
     void smartdisplay_led_set_rgb(bool r, bool g, bool b);
 #endif
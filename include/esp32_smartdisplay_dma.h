@@ -9,6 +9,16 @@
 #include <freertos/task.h>
 #include <lvgl.h>
 
+// Staging buffers used in turn once the completion of the panel transfers is tracked
+#ifndef SMARTDISPLAY_DMA_INFLIGHT_TRANSFERS
+#define SMARTDISPLAY_DMA_INFLIGHT_TRANSFERS 2
+#endif
+
+// Panels with their own DMA manager
+#ifndef SMARTDISPLAY_DMA_MAX_PANELS
+#define SMARTDISPLAY_DMA_MAX_PANELS 2
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -35,6 +45,9 @@ extern "C"
         smartdisplay_dma_callback_t callback; // Completion callback
         void *user_data;                      // User data for callback
         bool high_priority;                   // High priority transfer
+        lv_display_rotation_t rotation;       // Rotation applied while staging, LV_DISPLAY_ROTATION_0 for a plain copy
+        int32_t src_width, src_height;        // Unrotated source size in pixels (rotated transfers only)
+        uint32_t src_stride;                  // Unrotated source stride in bytes (rotated transfers only)
     } smartdisplay_dma_transfer_t;
 
     // DMA manager structure
@@ -50,26 +63,74 @@ extern "C"
         uint32_t active_transfers;           // Number of active transfers
         uint32_t completed_transfers;        // Total completed transfers
         uint32_t failed_transfers;           // Total failed transfers
+        uint8_t bits_per_pixel;              // Bits per pixel of the queued data, 16 (RGB565) or 12 (packed RGB444)
+        void *staging_buffers[SMARTDISPLAY_DMA_INFLIGHT_TRANSFERS]; // Staging buffers, the first is dma_buffer
+        uint8_t next_staging_buffer;         // Staging buffer used by the next chunk
+        SemaphoreHandle_t staging_free;      // Counts the staging buffers not being sent, NULL if the completion is not tracked
+        uint64_t bytes_transferred;          // Total bytes of the completed transfers
+        uint64_t busy_us;                    // Total time spent in the transfers
+        bool te_sync;                        // Worker transfers from the top row wait for the TE signal, set for the board panel
+        bool te_lost;                        // No recent TE edges, the transfers are not synchronized
     } smartdisplay_dma_manager_t;
 
     /**
      * @brief Initialize DMA manager for display transfers
      *
+     * Every panel has its own manager, buffers and worker task. The other functions take the panel handle
+     * to find its manager, they fail with ESP_ERR_INVALID_STATE for a panel without one.
+     *
+     * @param panel_handle LCD panel handle
+     * @param te_sync Synchronize the transfers with the TE signal (lcd_te), only for the panel driving the TE line
+     * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM if SMARTDISPLAY_DMA_MAX_PANELS managers exist
+     */
+    esp_err_t smartdisplay_dma_init(esp_lcd_panel_handle_t panel_handle, bool te_sync);
+
+    /**
+     * @brief Deinitialize the DMA manager of a panel
+     *
      * @param panel_handle LCD panel handle
      * @return esp_err_t ESP_OK on success
      */
-    esp_err_t smartdisplay_dma_init(esp_lcd_panel_handle_t panel_handle);
+    esp_err_t smartdisplay_dma_deinit(esp_lcd_panel_handle_t panel_handle);
 
     /**
-     * @brief Deinitialize DMA manager
+     * @brief Track the completion of the panel transfers to send from several staging buffers in turn
      *
+     * The on_color_trans_done callback of the panel IO must call smartdisplay_dma_trans_done_from_isr().
+     * A chunk is then copied into the next staging buffer while the previous chunks are sent, there is no
+     * delay between the chunks and a transfer is complete only once all of its chunks have been sent.
+     * Every esp_lcd_panel_draw_bitmap() must send exactly one color transfer. All the color writes of the panel
+     * then go through the worker: there are no direct draws of small transfers or when the queue is full.
+     *
+     * @param panel_handle LCD panel handle
      * @return esp_err_t ESP_OK on success
      */
-    esp_err_t smartdisplay_dma_deinit();
+    esp_err_t smartdisplay_dma_track_trans_done(esp_lcd_panel_handle_t panel_handle);
+
+    /**
+     * @brief Report the completion of a color transfer, from the on_color_trans_done callback of the panel IO
+     *
+     * @param panel_handle LCD panel handle the transfer was sent to
+     * @return true if a higher priority task has been woken
+     */
+    bool smartdisplay_dma_trans_done_from_isr(esp_lcd_panel_handle_t panel_handle);
+
+    /**
+     * @brief Set the pixel format of the data passed to the transfer functions
+     *
+     * The default is 16 (RGB565). With 12 (RGB444) two pixels are packed in three bytes, the rows of a
+     * transfer are contiguous so an odd width row ends halfway a byte.
+     *
+     * @param panel_handle LCD panel handle
+     * @param bits_per_pixel 12 or 16
+     * @return esp_err_t ESP_OK on success
+     */
+    esp_err_t smartdisplay_dma_set_bits_per_pixel(esp_lcd_panel_handle_t panel_handle, uint8_t bits_per_pixel);
 
     /**
      * @brief Queue a bitmap transfer with DMA optimization
      *
+     * @param panel_handle LCD panel handle
      * @param x_start Start X coordinate
      * @param y_start Start Y coordinate
      * @param x_end End X coordinate
@@ -80,33 +141,99 @@ extern "C"
      * @param high_priority High priority transfer flag
      * @return esp_err_t ESP_OK on success
      */
-    esp_err_t smartdisplay_dma_draw_bitmap(int x_start, int y_start, int x_end, int y_end, const void *color_data, smartdisplay_dma_callback_t callback, void *user_data, bool high_priority);
+    esp_err_t smartdisplay_dma_draw_bitmap(esp_lcd_panel_handle_t panel_handle, int x_start, int y_start, int x_end, int y_end, const void *color_data, smartdisplay_dma_callback_t callback, void *user_data, bool high_priority);
+
+    /**
+     * @brief Queue a bitmap transfer, without falling back to a direct transfer
+     *
+     * Transfers are executed in order, so completion of the last queued transfer implies completion of the earlier ones.
+     *
+     * @param panel_handle LCD panel handle
+     * @param x_start Start X coordinate
+     * @param y_start Start Y coordinate
+     * @param x_end End X coordinate
+     * @param y_end End Y coordinate
+     * @param color_data Pixel data to transfer, must stay valid until the transfer is done
+     * @param callback Completion callback (optional)
+     * @param user_data User data for callback (optional)
+     * @param high_priority High priority transfer flag
+     * @return esp_err_t ESP_OK on success, ESP_ERR_TIMEOUT if the queue is full
+     */
+    esp_err_t smartdisplay_dma_queue_bitmap(esp_lcd_panel_handle_t panel_handle, int x_start, int y_start, int x_end, int y_end, const void *color_data, smartdisplay_dma_callback_t callback, void *user_data, bool high_priority);
+
+    /**
+     * @brief Queue a bitmap transfer that is rotated while being staged into the DMA buffer
+     *
+     * The source is rotated chunk by chunk straight into the DMA staging buffer by the worker task,
+     * so no intermediate full size rotation buffer is needed. The source must stay valid until the callback is called.
+     * The transfer is always queued; there is no direct fallback as the source is not in panel order.
+     *
+     * @param panel_handle LCD panel handle
+     * @param x_start Start X coordinate (panel coordinates, after rotation)
+     * @param y_start Start Y coordinate (panel coordinates, after rotation)
+     * @param x_end End X coordinate (panel coordinates, after rotation)
+     * @param y_end End Y coordinate (panel coordinates, after rotation)
+     * @param src_data Unrotated RGB565 pixel data
+     * @param src_width Unrotated source width in pixels
+     * @param src_height Unrotated source height in pixels
+     * @param src_stride Unrotated source stride in bytes
+     * @param rotation Rotation to apply
+     * @param callback Completion callback (optional)
+     * @param user_data User data for callback (optional)
+     * @param high_priority High priority transfer flag
+     * @return esp_err_t ESP_OK on success, ESP_ERR_TIMEOUT if the queue is full
+     */
+    esp_err_t smartdisplay_dma_draw_bitmap_rotated(esp_lcd_panel_handle_t panel_handle, int x_start, int y_start, int x_end, int y_end, const void *src_data, int32_t src_width, int32_t src_height, uint32_t src_stride, lv_display_rotation_t rotation, smartdisplay_dma_callback_t callback, void *user_data, bool high_priority);
 
     /**
      * @brief Check if DMA transfer is recommended for given size
      *
+     * @param panel_handle LCD panel handle
      * @param data_len Data length in bytes
      * @return true if DMA should be used
      */
-    bool smartdisplay_dma_should_use_dma(size_t data_len);
+    bool smartdisplay_dma_should_use_dma(esp_lcd_panel_handle_t panel_handle, size_t data_len);
+
+    /**
+     * @brief Check if the completion of the transfers is tracked, see smartdisplay_dma_track_trans_done()
+     *
+     * @param panel_handle LCD panel handle
+     * @return true if the panel must not be drawn to directly
+     */
+    bool smartdisplay_dma_is_tracked(esp_lcd_panel_handle_t panel_handle);
 
     /**
      * @brief Wait for all pending DMA transfers to complete
      *
+     * @param panel_handle LCD panel handle
      * @param timeout_ms Timeout in milliseconds
      * @return esp_err_t ESP_OK on success, ESP_ERR_TIMEOUT on timeout
      */
-    esp_err_t smartdisplay_dma_wait_all_done(uint32_t timeout_ms);
+    esp_err_t smartdisplay_dma_wait_all_done(esp_lcd_panel_handle_t panel_handle, uint32_t timeout_ms);
 
     /**
      * @brief Get DMA manager statistics
      *
+     * @param panel_handle LCD panel handle
      * @param active_transfers Number of active transfers
      * @param completed_transfers Total completed transfers
      * @param failed_transfers Total failed transfers
      * @return esp_err_t ESP_OK on success
      */
-    esp_err_t smartdisplay_dma_get_stats(uint32_t *active_transfers, uint32_t *completed_transfers, uint32_t *failed_transfers);
+    esp_err_t smartdisplay_dma_get_stats(esp_lcd_panel_handle_t panel_handle, uint32_t *active_transfers, uint32_t *completed_transfers, uint32_t *failed_transfers);
+
+    /**
+     * @brief Get DMA manager throughput, bytes_transferred / busy_us is the achieved rate in MB/s
+     *
+     * Without tracked completion the time includes the delays between the chunks, not the end of the last chunk.
+     * With SMARTDISPLAY_DMA_BENCHMARK the rate is logged every SMARTDISPLAY_DMA_BENCHMARK_INTERVAL_MS.
+     *
+     * @param panel_handle LCD panel handle
+     * @param bytes_transferred Total bytes of the completed transfers
+     * @param busy_us Total time spent in the transfers in microseconds
+     * @return esp_err_t ESP_OK on success
+     */
+    esp_err_t smartdisplay_dma_get_throughput(esp_lcd_panel_handle_t panel_handle, uint64_t *bytes_transferred, uint64_t *busy_us);
 
     /**
      * @brief Flush LVGL display with DMA optimization
@@ -3,6 +3,13 @@
 #include <esp32_smartdisplay_dma.h>
 #include <lvgl.h>
 
+// te_sync of the board panel, its transfers from the top row wait for the TE signal when the board has one
+#ifdef DISPLAY_TE
+#define SMARTDISPLAY_DMA_BOARD_TE_SYNC true
+#else
+#define SMARTDISPLAY_DMA_BOARD_TE_SYNC false
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -15,8 +22,20 @@ extern "C"
      */
     void smartdisplay_dma_lvgl_flush_callback(bool success, void *user_data);
 
+    // Called from the DMA worker task once the last band of a refresh has been transferred
+    typedef void (*smartdisplay_dma_frame_flushed_cb_t)(lv_display_t *display);
+
+    /**
+     * @brief Set the callback called when the DMA completion of a flush is the last band of a refresh
+     * Flushes completed in the flush callback itself (small or direct transfers) do not call it
+     * @param cb Callback, NULL to remove it
+     */
+    void smartdisplay_dma_set_frame_flushed_cb(smartdisplay_dma_frame_flushed_cb_t cb);
+
     /**
      * @brief Optimized flush function for SPI/I80/QSPI panels with byte swapping
+     * With SMARTDISPLAY_RGB444 the pixels are packed to RGB444 (optionally dithered with SMARTDISPLAY_RGB444_DITHER) instead
+     * With DISPLAY_ROUND only the row spans inside the circle are swapped and sent, merged into windows
      * @param display LVGL display object
      * @param area Area to flush
      * @param px_map Pixel data buffer
@@ -26,36 +45,41 @@ extern "C"
      */
     esp_err_t smartdisplay_dma_flush_with_byteswap(lv_display_t *display, const lv_area_t *area, uint8_t *px_map, esp_lcd_panel_handle_t panel_handle, const char *panel_name);
 
+    /**
+     * @brief Same as smartdisplay_dma_flush_with_byteswap() without the byte swap, for a bus sending whole pixels (16 bit I80)
+     * @param display LVGL display object
+     * @param area Area to flush
+     * @param px_map Pixel data buffer
+     * @param panel_handle ESP LCD panel handle for fallback
+     * @param panel_name Panel name for logging
+     * @return ESP_OK if handled, ESP_FAIL if fallback needed
+     */
+    esp_err_t smartdisplay_dma_flush_no_byteswap(lv_display_t *display, const lv_area_t *area, uint8_t *px_map, esp_lcd_panel_handle_t panel_handle, const char *panel_name);
+
     /**
      * @brief Check if DMA should be used for a given transfer size
+     * @param panel_handle ESP LCD panel handle
      * @param transfer_size Size of transfer in bytes
      * @return true if DMA should be used, false otherwise
      */
-    bool smartdisplay_dma_should_use_for_size(size_t transfer_size);
+    bool smartdisplay_dma_should_use_for_size(esp_lcd_panel_handle_t panel_handle, size_t transfer_size);
 
     /**
      * @brief Initialize DMA for a panel with standardized logging
      * @param panel_handle ESP LCD panel handle
      * @param panel_name Panel name for logging
+     * @param te_sync Synchronize the transfers with the TE signal, see smartdisplay_dma_init()
      * @return ESP_OK on success, error code otherwise
      */
-    esp_err_t smartdisplay_dma_init_with_logging(esp_lcd_panel_handle_t panel_handle, const char *panel_name);
-
-    /**
-     * @brief Structure to pass both display and buffer to rotation callback
-     */
-    typedef struct
-    {
-        lv_display_t *display;
-        void *rotation_buffer;
-    } rotation_callback_data_t;
+    esp_err_t smartdisplay_dma_init_with_logging(esp_lcd_panel_handle_t panel_handle, const char *panel_name, bool te_sync);
 
     /**
-     * @brief DMA completion callback for rotated displays
-     * @param success Whether the DMA transfer was successful
-     * @param user_data Pointer to rotation_callback_data_t
+     * @brief Map an area of a display rotated in software to the window it is drawn to in panel coordinates
+     * @param display LVGL display object
+     * @param area Area in display coordinates
+     * @param panel_area Set to the area in panel coordinates
      */
-    void smartdisplay_dma_rotation_callback(bool success, void *user_data);
+    void smartdisplay_rotate_area(const lv_display_t *display, const lv_area_t *area, lv_area_t *panel_area);
 
     /**
      * @brief Optimized flush function for parallel panels with software rotation
@@ -68,6 +92,34 @@ extern "C"
      */
     esp_err_t smartdisplay_dma_flush_with_rotation(lv_display_t *display, const lv_area_t *area, uint8_t *px_map, esp_lcd_panel_handle_t panel_handle, const char *panel_name);
 
+#ifdef SMARTDISPLAY_SHADOW_FRAMEBUFFER
+    /**
+     * @brief Get the shadow framebuffer of a display, the content sent to the panel in LVGL pixel order
+     * @param display LVGL display object
+     * @param hor_res Set to the width of the shadow framebuffer
+     * @param ver_res Set to the height of the shadow framebuffer
+     * @return Shadow framebuffer, NULL until every row has been sent over its full width since it was invalidated
+     */
+    const uint16_t *smartdisplay_shadow_get(lv_display_t *display, int32_t *hor_res, int32_t *ver_res);
+
+    /**
+     * @brief Invalidate the shadow framebuffer of a display and redraw the screen, all pixels are sent until it is complete again
+     * Rotations invalidate it. Call it after a panel reset or anything else changing the frame memory outside of the flushes
+     * @param display LVGL display object
+     */
+    void smartdisplay_shadow_invalidate(lv_display_t *display);
+
+    /**
+     * @brief Scroll the shadow framebuffer like the frame memory after a hardware scroll
+     * The full width rows [y, y + height) move up by dy rows (down if negative), the rows scrolled out wrap around
+     * @param display LVGL display object
+     * @param y First row of the scrolling area
+     * @param height Rows of the scrolling area
+     * @param dy Rows scrolled
+     */
+    void smartdisplay_shadow_scroll(lv_display_t *display, int32_t y, int32_t height, int32_t dy);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <esp_err.h>
+#include <esp_lcd_panel_rgb.h>
+#include <lvgl.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // RGB panel statistics
+    typedef struct
+    {
+        uint32_t frames;      // Frames scanned out
+        uint32_t underruns;   // Frames whose last part was copied to a bounce buffer after the LCD started reading it, only counted with bounce buffers
+        uint32_t restarts;    // Restarts of the RGB transmission
+        uint32_t late_frames; // Frames whose last bounce buffer copy used more than half of its time, including the underruns
+        uint32_t pclk_hz;     // Current pixel clock
+    } smartdisplay_rgb_stats_t;
+
+    // Pixel clock governor policy
+    typedef struct
+    {
+        uint32_t min_pclk_hz;        // Lowest pixel clock, used at once for a heavy load hint
+        uint32_t step_hz;            // Pixel clock change of a step
+        uint32_t period_ms;          // Evaluation period
+        uint32_t late_frames_to_lower; // Late frames in a period that lower the pixel clock by a step, a frame counted in underruns always does
+        uint32_t periods_to_raise;   // Consecutive periods without late frames to raise the pixel clock by a step
+    } smartdisplay_rgb_governor_config_t;
+
+#define SMARTDISPLAY_RGB_GOVERNOR_CONFIG_DEFAULT(pclk_hz) \
+    {                                                   \
+        .min_pclk_hz = (pclk_hz) * 2 / 3,               \
+        .step_hz = (pclk_hz) / 12,                      \
+        .period_ms = 250,                               \
+        .late_frames_to_lower = 2,                      \
+        .periods_to_raise = 8,                          \
+    }
+
+    /**
+     * @brief Register the RGB panel used by the display
+     *
+     * Must be called by the RGB panel drivers after the panel has been created. There is a single RGB panel,
+     * ESP_ERR_INVALID_STATE is returned for another one.
+     * @param display LVGL display object
+     * @param rgb_panel RGB panel handle
+     * @param rgb_panel_config Configuration the RGB panel was created with
+     * @return ESP_OK on success, error code otherwise
+     */
+    esp_err_t smartdisplay_rgb_init(lv_display_t *display, esp_lcd_panel_handle_t rgb_panel, const esp_lcd_rgb_panel_config_t *rgb_panel_config);
+
+    /**
+     * @brief Frame done (vsync) handler shared by the RGB panel drivers
+     * @param panel RGB panel handle
+     * @param edata Event data
+     * @param user_ctx Pointer to lv_display_t
+     * @return true if a higher priority task was woken up
+     */
+    bool smartdisplay_rgb_frame_done(esp_lcd_panel_handle_t panel, esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx);
+
+    /**
+     * @brief Restart the RGB transmission, for example to recover from a picture drift
+     * @return ESP_OK on success, error code otherwise
+     */
+    esp_err_t smartdisplay_rgb_restart();
+
+    /**
+     * @brief Get the RGB panel statistics
+     * @param stats Statistics
+     * @return ESP_OK on success, error code otherwise
+     */
+    esp_err_t smartdisplay_rgb_get_stats(smartdisplay_rgb_stats_t *stats);
+
+    /**
+     * @brief Get the framebuffer being scanned out
+     * @param fb Set to the framebuffer, RGB565 in the orientation of the panel
+     * @param h_res Set to the width of the framebuffer
+     * @param v_res Set to the height of the framebuffer
+     * @return ESP_OK on success, error code otherwise
+     */
+    esp_err_t smartdisplay_rgb_get_frame_buffer(const uint16_t **fb, int32_t *h_res, int32_t *v_res);
+
+    /**
+     * @brief Start the pixel clock governor, that lowers the refresh rate of the RGB panel while the system is starved
+     *
+     * The governor follows the copies of the framebuffer to the bounce buffers: the copy of the last part of every frame
+     * is timed against the vsync. It is checked every period from an LVGL timer. Underruns and late frames lower the pixel
+     * clock down to min_pclk_hz, it is raised back up to the nominal clock when the copies are on time again. The nominal
+     * clock is the clock of the panel configuration.
+     * Needs bounce buffers, not available with SMARTDISPLAY_RGB_REFRESH_ON_DEMAND.
+     * @param config Policy, NULL for SMARTDISPLAY_RGB_GOVERNOR_CONFIG_DEFAULT of the nominal clock
+     * @return ESP_OK on success, error code otherwise
+     */
+    esp_err_t smartdisplay_rgb_governor_start(const smartdisplay_rgb_governor_config_t *config);
+
+    /**
+     * @brief Stop the pixel clock governor and restore the nominal pixel clock
+     * @return ESP_OK on success, error code otherwise
+     */
+    esp_err_t smartdisplay_rgb_governor_stop();
+
+    /**
+     * @brief Hint the governor of a heavy PSRAM load (for example Wi-Fi or storage transfers)
+     *
+     * While the hint is set the minimum pixel clock is used, it is raised as usual once the hint is cleared.
+     * @param heavy true before the load starts, false once it is done
+     * @return ESP_OK on success, error code otherwise
+     */
+    esp_err_t smartdisplay_rgb_governor_hint(bool heavy);
+
+#if defined(SMARTDISPLAY_RGB_BLIT) && !defined(SMARTDISPLAY_RGB_DIRECT_MODE)
+    /**
+     * @brief Flush callback writing the area straight into the framebuffer of the RGB panel, without the DMA manager
+     *
+     * The area is copied (or rotated) into the framebuffer using its stride, then only the touched lines are written
+     * back from the cache to PSRAM. The flush completes before returning. The RGB panel must be registered with
+     * smartdisplay_rgb_init. The display is rotated in software only, the panel swap_xy/mirror transform is not used.
+     * @param display LVGL display object
+     * @param area Area to flush
+     * @param px_map Pixel data buffer
+     */
+    void smartdisplay_rgb_blit_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map);
+#endif
+
+#ifdef SMARTDISPLAY_RGB_DIRECT_MODE
+    /**
+     * @brief Use the two framebuffers of the RGB panel as LVGL direct mode buffers
+     *
+     * LVGL renders straight into the framebuffer that is not scanned out. The last flush of a frame
+     * switches the panel to that framebuffer and completes at the next vsync. LVGL copies the dirty
+     * areas of the previous frame to the other buffer. The RGB panel must be created with two framebuffers
+     * and registered with smartdisplay_rgb_init. Rotation is not supported, the display is kept at LV_DISPLAY_ROTATION_0.
+     * @param display LVGL display object
+     * @return ESP_OK on success, error code otherwise
+     */
+    esp_err_t smartdisplay_rgb_direct_mode_init(lv_display_t *display);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
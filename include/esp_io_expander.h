@@ -7,9 +7,14 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -17,6 +22,10 @@ extern "C" {
 
 #define IO_COUNT_MAX        (sizeof(uint32_t) * 8)
 
+#ifndef IO_EXPANDER_INPUT_CB_MAX
+#define IO_EXPANDER_INPUT_CB_MAX    (4)
+#endif
+
 /**
  * @brief IO Expander Device Type
  *
@@ -83,9 +92,48 @@ typedef struct {
         uint8_t input_high_bit_zero : 1;    /*!< If the input level of IO is high, the corresponding bit of the input register is 0 */
         uint8_t output_high_bit_zero : 1;   /*!< If the output level of IO is high, the corresponding bit of the output register is 0 */
     } flags;
-    /* Don't support with interrupt mode yet, will be added soon */
 } esp_io_expander_config_t;
 
+/**
+ * @brief IO Expander Input Edge
+ *
+ */
+typedef enum {
+    IO_EXPANDER_EDGE_RISING  = (1 << 0),                                                /*!< Low to high */
+    IO_EXPANDER_EDGE_FALLING = (1 << 1),                                                /*!< High to low */
+    IO_EXPANDER_EDGE_ANY     = (IO_EXPANDER_EDGE_RISING | IO_EXPANDER_EDGE_FALLING),    /*!< Both */
+} esp_io_expander_edge_t;
+
+/**
+ * @brief Input change callback, called from the interrupt task
+ *
+ * @param handle: IO Expander handle
+ * @param pin_num_mask: Bitwise OR of the changed pins matching the registration
+ * @param level_mask: Levels of the pins of the registration after the change. For each bit, 0 - Low level, 1 - High level
+ * @param user_ctx: User context passed at registration
+ */
+typedef void (*esp_io_expander_input_cb_t)(esp_io_expander_handle_t handle, uint32_t pin_num_mask, uint32_t level_mask, void *user_ctx);
+
+/**
+ * @brief Input change callback registration
+ *
+ */
+typedef struct {
+    esp_io_expander_input_cb_t cb;  /*!< Callback, NULL if the slot is free */
+    uint32_t pin_num_mask;          /*!< Pins watched */
+    esp_io_expander_edge_t edge;    /*!< Edges reported */
+    void *user_ctx;                 /*!< User context */
+} esp_io_expander_input_watch_t;
+
+/**
+ * @brief IO Expander Statistics
+ *
+ */
+typedef struct {
+    uint32_t transactions;          /*!< Register reads and writes sent to the device */
+    uint32_t transactions_avoided;  /*!< Register reads served by the cache and writes skipped as the value was unchanged */
+} esp_io_expander_stats_t;
+
 struct esp_io_expander_s {
 
     /**
@@ -160,6 +208,21 @@ struct esp_io_expander_s {
      */
     esp_err_t (*read_direction_reg)(esp_io_expander_handle_t handle, uint32_t *value);
 
+    /**
+     * @brief Write several values to output register in one bus transaction (optional)
+     *
+     * @note The values are applied one after the other, in order
+     * @note If not implemented, `write_output_reg` is called for every value
+     *
+     * @param handle: IO Expander handle
+     * @param values: Register's values
+     * @param count: Number of values
+     *
+     * @return
+     *      - ESP_OK: Success, otherwise returns ESP_ERR_xxx
+     */
+    esp_err_t (*write_output_reg_burst)(esp_io_expander_handle_t handle, const uint32_t *values, size_t count);
+
     /**
      * @brief Reset the device to its initial state (mandatory)
      *
@@ -186,8 +249,59 @@ struct esp_io_expander_s {
      * @brief Configuration structure
      */
     esp_io_expander_config_t config;
+
+    /**
+     * @brief Shadow copy of output and direction registers, kept by the functions below (zero initialized by the device)
+     */
+    struct {
+        uint32_t output;                    /*!< Value of output register */
+        uint32_t direction;                 /*!< Value of direction register */
+        uint32_t input;                     /*!< Value of input register, only kept while the interrupt is enabled */
+        uint32_t output_valid: 1;           /*!< If this flag is enabled, `output` matches the device */
+        uint32_t direction_valid: 1;        /*!< If this flag is enabled, `direction` matches the device */
+        uint32_t input_valid: 1;            /*!< If this flag is enabled, `input` matches the device */
+    } cache;
+
+    /**
+     * @brief Statistics
+     */
+    esp_io_expander_stats_t stats;
+
+    /**
+     * @brief Serializes the register accesses of the tasks and the other functions, created by the first call on the device
+     */
+    SemaphoreHandle_t lock;
+
+    /**
+     * @brief Asynchronous writes, created by the first call of `esp_io_expander_set_levels_async()`
+     */
+    struct {
+        QueueHandle_t queue;                /*!< Pending writes */
+        TaskHandle_t task;                  /*!< Worker task */
+    } async;
+
+    /**
+     * @brief Input change detection, enabled by `esp_io_expander_enable_interrupt()`
+     */
+    struct {
+        int gpio_num;                       /*!< GPIO connected to the INT line of the device */
+        TaskHandle_t task;                  /*!< Task reading the input register when the INT line is asserted */
+        uint32_t input;                     /*!< Value of input register at the last change */
+        bool stop;                          /*!< Set by `esp_io_expander_del()` to stop the task */
+        SemaphoreHandle_t stopped;          /*!< Given by the task when it exits */
+        esp_io_expander_input_watch_t cbs[IO_EXPANDER_INPUT_CB_MAX];   /*!< Registered callbacks */
+    } interrupt;
 };
 
+/**
+ * @brief Completion callback of an asynchronous write, called from the worker task
+ *
+ * @param handle: IO Expander handle
+ * @param result: ESP_OK on success, otherwise ESP_ERR_xxx
+ * @param user_ctx: User context passed with the write
+ */
+typedef void (*esp_io_expander_async_cb_t)(esp_io_expander_handle_t handle, esp_err_t result, void *user_ctx);
+
 /**
  * @brief Set the direction of a set of target IOs
  *
@@ -204,6 +318,7 @@ esp_err_t esp_io_expander_set_dir(esp_io_expander_handle_t handle, uint32_t pin_
  * @brief Set the output level of a set of target IOs
  *
  * @note All target IOs must be in output mode first, otherwise this function will return the error `ESP_ERR_INVALID_STATE`
+ * @note Once output and direction registers are in the shadow copy, this costs one register write, or none if the level is unchanged
  *
  * @param handle: IO Exapnder handle
  * @param pin_num_mask: Bitwise OR of allowed pin num with type of `esp_io_expander_pin_num_t`
@@ -214,10 +329,60 @@ esp_err_t esp_io_expander_set_dir(esp_io_expander_handle_t handle, uint32_t pin_
  */
 esp_err_t esp_io_expander_set_level(esp_io_expander_handle_t handle, uint32_t pin_num_mask, uint8_t level);
 
+/**
+ * @brief Set the output levels of a set of target IOs at once, in one register write
+ *
+ * @note All target IOs must be in output mode first, otherwise this function will return the error `ESP_ERR_INVALID_STATE`
+ *
+ * @param handle: IO Exapnder handle
+ * @param pin_num_mask: Bitwise OR of allowed pin num with type of `esp_io_expander_pin_num_t`
+ * @param level_mask: Levels of the target IOs, bitwise OR of the high pins
+ *
+ * @return
+ *      - ESP_OK: Success, otherwise returns ESP_ERR_xxx
+ */
+esp_err_t esp_io_expander_set_levels(esp_io_expander_handle_t handle, uint32_t pin_num_mask, uint32_t level_mask);
+
+/**
+ * @brief Queue a write of the output levels of a set of target IOs to a worker task
+ *
+ * @note The writes are applied in order. This function only blocks while the queue is full
+ * @note The first call creates the worker task, `esp_io_expander_del()` stops it
+ *
+ * @param handle: IO Exapnder handle
+ * @param pin_num_mask: Bitwise OR of allowed pin num with type of `esp_io_expander_pin_num_t`
+ * @param level_mask: Levels of the target IOs, bitwise OR of the high pins
+ * @param cb: Called when the write is done, can be NULL
+ * @param user_ctx: User context passed to the callback
+ *
+ * @return
+ *      - ESP_OK: Success, otherwise returns ESP_ERR_xxx
+ */
+esp_err_t esp_io_expander_set_levels_async(esp_io_expander_handle_t handle, uint32_t pin_num_mask, uint32_t level_mask,
+                                           esp_io_expander_async_cb_t cb, void *user_ctx);
+
+/**
+ * @brief Apply a sequence of output levels to a set of target IOs, for example a bit-banged waveform
+ *
+ * @note All target IOs must be in output mode first, otherwise this function will return the error `ESP_ERR_INVALID_STATE`
+ * @note The registers are read once, then every step that changes the output costs one register write.
+ *       The writes are sent in bursts if the device implements `write_output_reg_burst`
+ *
+ * @param handle: IO Exapnder handle
+ * @param pin_num_mask: Bitwise OR of allowed pin num with type of `esp_io_expander_pin_num_t`
+ * @param levels: Levels of the target IOs for every step, bitwise OR of the high pins
+ * @param count: Number of steps
+ *
+ * @return
+ *      - ESP_OK: Success, otherwise returns ESP_ERR_xxx
+ */
+esp_err_t esp_io_expander_set_level_sequence(esp_io_expander_handle_t handle, uint32_t pin_num_mask, const uint32_t *levels, size_t count);
+
 /**
  * @brief Get the intput level of a set of target IOs
  *
  * @note This function can be called whenever target IOs are in input mode or output mode
+ * @note While the interrupt is enabled, the levels are read from the shadow copy, without register access
  *
  * @param handle: IO Exapnder handle
  * @param pin_num_mask: Bitwise OR of allowed pin num with type of `esp_io_expander_pin_num_t`
@@ -228,6 +393,39 @@ esp_err_t esp_io_expander_set_level(esp_io_expander_handle_t handle, uint32_t pi
  */
 esp_err_t esp_io_expander_get_level(esp_io_expander_handle_t handle, uint32_t pin_num_mask, uint32_t *level_mask);
 
+/**
+ * @brief Watch the INT line of the device to keep the shadow copy of the input register and report input changes
+ *
+ * @note The INT line is active low, open drain: the GPIO is configured as input with pull-up. The GPIO ISR service is installed if needed
+ * @note The input register is read by a task when the line falls, callbacks registered by
+ *       `esp_io_expander_register_input_cb()` are called from this task
+ * @note While a read fails or the line stays low, the register is polled every `IO_EXPANDER_INTERRUPT_POLL_MS`
+ *
+ * @param handle: IO Expander handle
+ * @param gpio_num: GPIO connected to the INT line
+ *
+ * @return
+ *      - ESP_OK: Success, otherwise returns ESP_ERR_xxx
+ */
+esp_err_t esp_io_expander_enable_interrupt(esp_io_expander_handle_t handle, int gpio_num);
+
+/**
+ * @brief Register a callback for the changes of a set of target IOs
+ *
+ * @note The changes are only detected while the interrupt is enabled
+ *
+ * @param handle: IO Expander handle
+ * @param pin_num_mask: Bitwise OR of allowed pin num with type of `esp_io_expander_pin_num_t`
+ * @param edge: Edges reported
+ * @param cb: Callback
+ * @param user_ctx: User context passed to the callback
+ *
+ * @return
+ *      - ESP_OK: Success, ESP_ERR_NO_MEM if `IO_EXPANDER_INPUT_CB_MAX` callbacks are registered, otherwise returns ESP_ERR_xxx
+ */
+esp_err_t esp_io_expander_register_input_cb(esp_io_expander_handle_t handle, uint32_t pin_num_mask, esp_io_expander_edge_t edge,
+                                            esp_io_expander_input_cb_t cb, void *user_ctx);
+
 /**
  * @brief Print the current status of each IO of the device, including direction, input level and output level
  *
@@ -241,7 +439,7 @@ esp_err_t esp_io_expander_print_state(esp_io_expander_handle_t handle);
 /**
  * @brief Reset the device to its initial status
  *
- * @note This function will reset all device's registers
+ * @note This function will reset all device's registers, the shadow copy of the registers is invalidated
  *
  * @param handle: IO Expander handle
  *
@@ -250,9 +448,22 @@ esp_err_t esp_io_expander_print_state(esp_io_expander_handle_t handle);
  */
 esp_err_t esp_io_expander_reset(esp_io_expander_handle_t handle);
 
+/**
+ * @brief Get the statistics of the register accesses
+ *
+ * @param handle: IO Expander handle
+ * @param stats: Statistics
+ *
+ * @return
+ *      - ESP_OK: Success, otherwise returns ESP_ERR_xxx
+ */
+esp_err_t esp_io_expander_get_stats(esp_io_expander_handle_t handle, esp_io_expander_stats_t *stats);
+
 /**
  * @brief Delete device
  *
+ * @note Pending asynchronous writes are dropped, the interrupt is disabled and the INT GPIO is reset
+ *
  * @param handle: IO Expander handle
  *
  * @return
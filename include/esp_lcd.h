@@ -15,3 +15,48 @@ typedef struct
     uint8_t bytes;           // Size of the data buffer for the command
     unsigned short delay_ms; // Delay in milliseconds after the command
 } lcd_init_cmd_t;
+
+// Compact init sequence: command, parameter count, parameters.
+// When LCD_INIT_DELAY is set in the count, a delay byte in milliseconds follows the parameters.
+#define LCD_INIT_DELAY 0x80
+
+// Boot phases measured by the panel drivers
+typedef enum
+{
+    LCD_BOOT_PHASE_RESET,       // Reset pulse and mandatory wait
+    LCD_BOOT_PHASE_SLPOUT_WAIT, // Waiting for the reset to SLPOUT deadline and after SLPOUT
+    LCD_BOOT_PHASE_INIT_TABLE,  // MADCTL, COLMOD and vendor initialization commands
+    LCD_BOOT_PHASE_DISPON,      // Display on
+    LCD_BOOT_PHASE_MAX
+} lcd_boot_phase_t;
+
+// Tearing effect output
+typedef struct
+{
+    uint32_t frame_count;   // Number of vertical blanking periods since enabled
+    int64_t last_vblank_us; // Time of the start of the last vertical blanking period
+    uint32_t period_us;     // Measured refresh period, 0 if not known yet
+} lcd_te_info_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    esp_err_t lcd_tx_init_bytecode(esp_lcd_panel_io_handle_t io, const uint8_t *bytecode, size_t size);
+    esp_err_t lcd_tx_init_cmds(esp_lcd_panel_io_handle_t io, const lcd_init_cmd_t *cmds, size_t count);
+    void lcd_wait_until(int64_t deadline_us);
+
+    void lcd_boot_profile_add(lcd_boot_phase_t phase, int64_t start_us);
+    void lcd_boot_profile_log(void);
+
+    // Send TEON (V-blank only) and count the rising edges of the TE output of the controller on te_gpio
+    esp_err_t lcd_te_enable(esp_lcd_panel_io_handle_t io, gpio_num_t te_gpio);
+    bool lcd_te_enabled(void);
+    // Wait for the start of the next vertical blanking period, ESP_ERR_INVALID_STATE if TE is not enabled
+    esp_err_t lcd_te_wait_vblank(uint32_t timeout_ms);
+    esp_err_t lcd_te_get_info(lcd_te_info_t *info);
+
+#ifdef __cplusplus
+}
+#endif
@@ -69,10 +69,12 @@ typedef struct {
 } esp_lcd_panel_io_3wire_spi_config_t;
 
 /**
- * @brief Create a new panel IO instance for 3-wire SPI interface (simulate by software)
+ * @brief Create a new panel IO instance for 3-wire SPI interface
  *
- * @note  This function uses GPIO or IO expander to simulate SPI interface by software and just supports to write data.
- *        It is only suitable for some applications with low speed SPI interface. (Such as initializing RGB panel)
+ * @note  When all lines are GPIOs, the 9-bit packages are sent by the SPI peripheral `PANEL_IO_3WIRE_SPI_HOST` at
+ *        `PANEL_IO_3WIRE_SPI_HW_CLK`, unless `PANEL_IO_3WIRE_SPI_USE_HW` is 0 or the host is already in use.
+ *        Otherwise this function uses GPIO or IO expander to simulate SPI interface by software at `expect_clk_speed`.
+ *        Only writing data is supported. It is only suitable for some applications with low speed SPI interface. (Such as initializing RGB panel)
  *
  * @param[in]  io_config Panel IO configuration
  * @param[out] ret_io    Pointer to return the created panel IO instance
@@ -84,6 +86,20 @@ typedef struct {
  */
 esp_err_t esp_lcd_new_panel_io_3wire_spi(const esp_lcd_panel_io_3wire_spi_config_t *io_config, esp_lcd_panel_io_handle_t *ret_io);
 
+/**
+ * @brief Release the SPI peripheral, for example after the init sequence, the packages that follow are bit-banged
+ *
+ * @note  The SPI host `PANEL_IO_3WIRE_SPI_HOST` (default `SPI2_HOST`) can be set by the board. It is free again for
+ *        other devices after this call. Nothing is done if the lines are already bit-banged.
+ *
+ * @param[in] io Panel IO instance created by `esp_lcd_new_panel_io_3wire_spi()`
+ * @return
+ *      - ESP_OK:              Success
+ *      - ESP_ERR_INVALID_ARG: Invalid argument
+ *      - Others:              Fail
+ */
+esp_err_t esp_lcd_panel_io_3wire_spi_release_bus(esp_lcd_panel_io_handle_t io);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,21 +1,18 @@
 #pragma once
 
-#include <esp_lcd.h>
-#include <esp_lcd_types.h>
-#include <esp_lcd_panel_vendor.h>
+#include <esp_panel_dcs.h>
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
-    typedef struct
-    {
-        const lcd_init_cmd_t *init_cmds;
-        uint16_t init_cmds_size;
-    } axs15231b_vendor_config_t;
+    typedef dcs_vendor_config_t axs15231b_vendor_config_t;
 
     esp_err_t esp_lcd_new_panel_axs15231b(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *config, esp_lcd_panel_handle_t *handle);
+    // QSPI mode: wrap an SPI panel IO created with quad_mode and 32 command bits, then create the panel on the wrapped IO
+    esp_err_t esp_lcd_new_panel_io_axs15231b_qspi(const esp_lcd_panel_io_handle_t spi_io, esp_lcd_panel_io_handle_t *io);
+    esp_err_t esp_lcd_new_panel_axs15231b_qspi(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *config, esp_lcd_panel_handle_t *handle);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <esp_lcd.h>
+#include <esp_lcd_types.h>
+#include <esp_lcd_panel_vendor.h>
+
+// Controller quirks
+#define DCS_QUIRK_SOFTWARE_RESET BIT(0)  // Always use SWRESET, the reset line is not used
+#define DCS_QUIRK_INIT_IN_RESET BIT(1)   // Send the init sequence after the reset as well
+#define DCS_QUIRK_SLPOUT_FIRST BIT(2)    // Send SLPOUT before the init sequence instead of after
+#define DCS_QUIRK_RAMWRC_CONTINUE BIT(3) // RASET is ignored, rows are written top down: RAMWR from row 0, RAMWRC otherwise
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Parameters of the frame rate control command for a refresh rate
+    typedef struct
+    {
+        uint8_t hz;
+        uint8_t params[2];
+    } dcs_frame_rate_t;
+
+    // Description of a MIPI-DCS controller, all controller specifics are here
+    typedef struct
+    {
+        const char *name;
+        const uint8_t *init_bytecode; // Default vendor init sequence, see LCD_INIT_DELAY
+        size_t init_bytecode_size;
+        // COLMOD values, 0 if not supported
+        uint8_t colmod_rgb444; // 12 bits per pixel, two pixels packed in three bytes
+        uint8_t colmod_rgb565;
+        uint8_t colmod_rgb666;
+        uint8_t colmod_rgb888;
+        uint16_t gram_lines;      // Rows of the frame memory, 0 if vertical scrolling is not supported
+        // Frame memory read (RAMRD), the pixels are read as RGB666 in three bytes after the dummy clocks
+        bool ramrd;
+        uint8_t ramrd_dummy_bits;
+        // Frame rate control (normal mode), frame_rates is NULL if not supported
+        uint8_t frame_rate_cmd;
+        uint8_t frame_rate_params_size;
+        const dcs_frame_rate_t *frame_rates; // Ordered by descending rate
+        size_t frame_rates_count;
+        uint8_t frame_rate_hz; // Rate set by the init sequence
+        uint16_t reset_delay_ms;  // Delay after reset before SLPOUT may be sent
+        uint16_t slpout_delay_ms; // Delay after SLPOUT before the next command
+        uint32_t quirks;          // DCS_QUIRK_*
+    } dcs_panel_descriptor_t;
+
+    typedef struct
+    {
+        const lcd_init_cmd_t *init_cmds;
+        uint16_t init_cmds_size;
+    } dcs_vendor_config_t;
+
+    esp_err_t esp_lcd_new_panel_dcs(const dcs_panel_descriptor_t *descriptor, const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *config, esp_lcd_panel_handle_t *handle);
+
+    // Scroll the full width rows [y, y + height) up by lines (down if negative) using VSCRDEF/VSCRSADD.
+    // Later draws in the area are remapped, so only the exposed lines have to be sent. A height of 0 ends scrolling.
+    // Not supported when X and Y are swapped.
+    esp_err_t esp_lcd_panel_dcs_scroll(esp_lcd_panel_handle_t panel, int y, int height, int lines);
+
+    // Set the internal refresh rate to the supported rate closest to hz, 0 for the rate of the init sequence
+    esp_err_t esp_lcd_panel_dcs_set_frame_rate(esp_lcd_panel_handle_t panel, uint32_t hz);
+    // Idle mode (IDMON/IDMOFF): 8 colors, the MSB of every channel, at a lower power
+    esp_err_t esp_lcd_panel_dcs_set_idle_mode(esp_lcd_panel_handle_t panel, bool idle);
+    // Partial mode (PTLAR/PTLON): only the display rows [y, y + height) are refreshed, the others show the background.
+    // A height of 0 returns to normal mode (NORON). Not supported when X and Y are swapped
+    esp_err_t esp_lcd_panel_dcs_set_partial_area(esp_lcd_panel_handle_t panel, int y, int height);
+    // Read the pixels [x_start, x_end) x [y_start, y_end) back from the frame memory (RAMRD) as RGB565, in the byte order of the CPU.
+    // Rows in the scrolling area are read where they are displayed. The panel IO must be idle and able to receive
+    esp_err_t esp_lcd_panel_dcs_read_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end, uint16_t *rgb565);
+
+#ifdef __cplusplus
+}
+#endif
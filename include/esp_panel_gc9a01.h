@@ -1,19 +1,13 @@
 #pragma once
 
-#include <esp_lcd.h>
-#include <esp_lcd_types.h>
-#include <esp_lcd_panel_vendor.h>
+#include <esp_panel_dcs.h>
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
-    typedef struct
-    {
-        const lcd_init_cmd_t *init_cmds;
-        uint16_t init_cmds_size;
-    } gc9a01_vendor_config_t;
+    typedef dcs_vendor_config_t gc9a01_vendor_config_t;
 
     esp_err_t esp_lcd_new_panel_gc9a01(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *config, esp_lcd_panel_handle_t *handle);
 
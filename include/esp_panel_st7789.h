@@ -0,0 +1,17 @@
+#pragma once
+
+#include <esp_panel_dcs.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef dcs_vendor_config_t st7789_vendor_config_t;
+
+    // Named apart from esp_lcd_new_panel_st7789 of ESP-IDF, that only supports 16 and 18 bits per pixel
+    esp_err_t esp_lcd_new_panel_st7789_dcs(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *config, esp_lcd_panel_handle_t *handle);
+
+#ifdef __cplusplus
+}
+#endif
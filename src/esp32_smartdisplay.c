@@ -1,5 +1,21 @@
 #include <esp32_smartdisplay.h>
 #include <esp_lcd_panel_ops.h>
+#include <esp_lcd.h>
+
+#ifdef SMARTDISPLAY_DCS_PANEL
+#include <esp_panel_dcs.h>
+#include <esp32_smartdisplay_dma.h>
+#endif
+
+#if defined(DISPLAY_ST7262_PAR) || defined(DISPLAY_ST7701_PAR)
+#include <esp32_smartdisplay_rgb.h>
+// Panels with a framebuffer
+#define SMARTDISPLAY_RGB_PANEL
+#endif
+
+#ifdef SMARTDISPLAY_SHADOW_FRAMEBUFFER
+#include <esp32_smartdisplay_dma_helpers.h>
+#endif
 
 #ifdef BOARD_HAS_TOUCH
 #include <esp_lcd_touch.h>
@@ -10,11 +26,23 @@
 #define BRIGHTNESS_DARK_ZONE 250
 
 // Functions to be defined in the tft/touch driver
-extern lv_display_t *lvgl_lcd_init();
+extern lv_display_t *lvgl_lcd_init(const smartdisplay_config_t *config);
 extern lv_indev_t *lvgl_touch_init();
 
+// Board display, the one with the backlight, touch and the single display features
 lv_display_t *display;
 
+struct smartdisplay
+{
+  lv_display_t *display;
+  smartdisplay_hw_rotation_t hw_rotation;
+  uint32_t refresh_period_ms;
+  bool frame_sync; // Refreshed on TE, the refresh timer only runs if the TE signal is lost
+};
+
+smartdisplay_t smartdisplays[SMARTDISPLAY_MAX_DISPLAYS];
+uint8_t smartdisplay_count;
+
 #ifdef BOARD_HAS_TOUCH
 lv_indev_t *indev;
 touch_calibration_data_t touch_calibration_data;
@@ -25,6 +53,34 @@ void lvgl_display_resolution_changed_callback(lv_event_t *drv);
 
 lv_timer_t *update_brightness_timer;
 
+// Power policy
+#ifndef SMARTDISPLAY_IDLE_FRAME_RATE
+#define SMARTDISPLAY_IDLE_FRAME_RATE 30
+#endif
+
+lv_timer_t *power_policy_timer;
+smartdisplay_lcd_power_policy_cb_t power_policy_cb;
+uint32_t power_policy_idle_ms;
+uint32_t power_policy_last_render;
+bool power_policy_idle;
+#ifdef SMARTDISPLAY_DCS_PANEL
+// Display rows still refreshed by the DCS power policy while idle
+int power_policy_partial_y;
+int power_policy_partial_height;
+#endif
+
+#ifdef DISPLAY_TE
+#include <esp_timer.h>
+// Polling interval of the TE frame counter by the LVGL timer handler.
+// 0 for a quarter of the measured refresh period of the panel, sleeping until shortly before the frame of the next refresh
+#ifndef SMARTDISPLAY_FRAME_SYNC_POLL_MS
+#define SMARTDISPLAY_FRAME_SYNC_POLL_MS 0
+#endif
+
+uint32_t smartdisplay_event_frame_sync;
+lv_timer_t *frame_sync_timer;
+#endif
+
 #ifdef LV_USE_LOG
 void lvgl_log(lv_log_level_t level, const char *buf)
 {
@@ -106,6 +162,326 @@ void smartdisplay_lcd_set_brightness_cb(smartdisplay_lcd_adaptive_brightness_cb_
     smartdisplay_lcd_set_backlight(0.5f);
 }
 
+void smartdisplay_lcd_scroll(lv_obj_t *obj, int32_t dy)
+{
+  log_v("obj:0x%08x, dy:%d", obj, dy);
+
+#ifdef SMARTDISPLAY_DCS_PANEL
+  static lv_area_t scroll_area;
+  lv_display_t *display = lv_obj_get_display(obj);
+  lv_area_t area;
+  lv_obj_get_coords(obj, &area);
+  area.y1 = LV_MAX(area.y1, 0);
+  area.y2 = LV_MIN(area.y2, lv_display_get_vertical_resolution(display) - 1);
+  // Only full width areas can be scrolled by the panel
+  if (display == smartdisplay_get_lv_display(smartdisplay_get_default()) && dy != 0 && area.x1 <= 0 && area.x2 >= lv_display_get_horizontal_resolution(display) - 1 && LV_ABS(dy) < lv_area_get_height(&area))
+  {
+    area.x1 = 0;
+    area.x2 = lv_display_get_horizontal_resolution(display) - 1;
+    // Pending changes are drawn with the current scroll offset
+    lv_refr_now(display);
+    smartdisplay_dma_wait_all_done(display->user_data, SMARTDISPLAY_DMA_TIMEOUT_MS);
+    if (esp_lcd_panel_dcs_scroll(display->user_data, area.y1, lv_area_get_height(&area), dy) == ESP_OK)
+    {
+      // Move the content without redrawing it, the panel shows it at the new position already
+      lv_display_enable_invalidation(display, false);
+      lv_obj_scroll_by(obj, 0, -dy, LV_ANIM_OFF);
+      lv_display_enable_invalidation(display, true);
+      if (!lv_area_is_equal(&area, &scroll_area))
+      {
+        // A new area restarts unscrolled, redraw the previous and the new area
+#ifdef SMARTDISPLAY_SHADOW_FRAMEBUFFER
+        // The frame memory of both areas is no longer where the shadow has it
+        smartdisplay_shadow_invalidate(display);
+#endif
+        lv_inv_area(display, &scroll_area);
+        lv_inv_area(display, &area);
+        scroll_area = area;
+        return;
+      }
+
+#ifdef SMARTDISPLAY_SHADOW_FRAMEBUFFER
+      smartdisplay_shadow_scroll(display, area.y1, lv_area_get_height(&area), dy);
+#endif
+
+      // Draw the exposed lines only
+      lv_area_t exposed = area;
+      if (dy > 0)
+        exposed.y1 = area.y2 - dy + 1;
+      else
+        exposed.y2 = area.y1 - dy - 1;
+
+      lv_inv_area(display, &exposed);
+      return;
+    }
+  }
+#endif
+
+  lv_obj_scroll_by(obj, 0, -dy, LV_ANIM_OFF);
+}
+
+// Screenshot stream, RLE runs are collected before they are written
+#define CAPTURE_RLE_RUNS 64
+
+typedef struct
+{
+  smartdisplay_capture_format_t format;
+  smartdisplay_capture_write_cb_t write;
+  void *user_data;
+  uint16_t color;
+  uint32_t run;
+  size_t used;
+  uint8_t buffer[CAPTURE_RLE_RUNS * 3];
+} capture_stream_t;
+
+bool capture_put_run(capture_stream_t *stream)
+{
+  if (stream->used == sizeof(stream->buffer))
+  {
+    if (!stream->write(stream->buffer, stream->used, stream->user_data))
+      return false;
+
+    stream->used = 0;
+  }
+
+  stream->buffer[stream->used++] = stream->run - 1;
+  stream->buffer[stream->used++] = stream->color;
+  stream->buffer[stream->used++] = stream->color >> 8;
+  stream->run = 0;
+  return true;
+}
+
+bool capture_put_row(capture_stream_t *stream, const uint16_t *pixels, int32_t width)
+{
+  if (stream->format == SMARTDISPLAY_CAPTURE_RAW)
+    return stream->write(pixels, width * sizeof(uint16_t), stream->user_data);
+
+  for (int32_t x = 0; x < width; x++)
+  {
+    if (stream->run > 0 && (pixels[x] != stream->color || stream->run == 256) && !capture_put_run(stream))
+      return false;
+
+    stream->color = pixels[x];
+    stream->run++;
+  }
+
+  return true;
+}
+
+bool capture_finish(capture_stream_t *stream)
+{
+  if (stream->run > 0 && !capture_put_run(stream))
+    return false;
+
+  return stream->used == 0 || stream->write(stream->buffer, stream->used, stream->user_data);
+}
+
+esp_err_t smartdisplay_lcd_capture(smartdisplay_capture_source_t source, smartdisplay_capture_format_t format, smartdisplay_capture_write_cb_t write, void *user_data)
+{
+  log_v("source:%d, format:%d, write:0x%08x, user_data:0x%08x", source, format, write, user_data);
+  if (write == NULL || (format != SMARTDISPLAY_CAPTURE_RAW && format != SMARTDISPLAY_CAPTURE_RLE))
+    return ESP_ERR_INVALID_ARG;
+
+  // Frame in memory, NULL if the rows are read from the panel
+  const uint16_t *frame = NULL;
+  int32_t width = lv_display_get_horizontal_resolution(display);
+  int32_t height = lv_display_get_vertical_resolution(display);
+  esp_err_t res;
+  switch (source)
+  {
+  case SMARTDISPLAY_CAPTURE_PANEL:
+#if defined(SMARTDISPLAY_RGB_PANEL)
+    if ((res = smartdisplay_rgb_get_frame_buffer(&frame, &width, &height)) != ESP_OK)
+      return res;
+
+    break;
+#elif defined(SMARTDISPLAY_DCS_PANEL)
+    // The reads must not interleave with queued transfers
+    smartdisplay_dma_wait_all_done(display->user_data, SMARTDISPLAY_DMA_TIMEOUT_MS);
+    break;
+#else
+    log_w("Reading back the display is not supported");
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+  case SMARTDISPLAY_CAPTURE_RENDERED:
+#ifdef SMARTDISPLAY_SHADOW_FRAMEBUFFER
+    if ((frame = smartdisplay_shadow_get(display, &width, &height)) == NULL)
+    {
+      log_w("Shadow framebuffer is not complete yet");
+      return ESP_ERR_INVALID_STATE;
+    }
+
+    break;
+#else
+    log_w("Capturing the rendered content requires SMARTDISPLAY_SHADOW_FRAMEBUFFER");
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+  default:
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  uint16_t *row = NULL;
+  if (frame == NULL && (row = malloc(width * sizeof(uint16_t))) == NULL)
+    return ESP_ERR_NO_MEM;
+
+  capture_stream_t stream = {.format = format, .write = write, .user_data = user_data};
+  const smartdisplay_capture_header_t header = {
+      .magic = SMARTDISPLAY_CAPTURE_MAGIC,
+      .version = SMARTDISPLAY_CAPTURE_VERSION,
+      .format = format,
+      .width = width,
+      .height = height};
+
+  res = write(&header, sizeof(header), user_data) ? ESP_OK : ESP_FAIL;
+  for (int32_t y = 0; y < height && res == ESP_OK; y++)
+  {
+    const uint16_t *pixels = frame != NULL ? frame + y * width : row;
+#ifdef SMARTDISPLAY_DCS_PANEL
+    if (frame == NULL && (res = esp_lcd_panel_dcs_read_bitmap(display->user_data, 0, y, width, y + 1, row)) != ESP_OK)
+      break;
+#endif
+    if (!capture_put_row(&stream, pixels, width))
+      res = ESP_FAIL;
+  }
+
+  if (res == ESP_OK && !capture_finish(&stream))
+    res = ESP_FAIL;
+
+  free(row);
+  return res;
+}
+
+#ifdef DISPLAY_TE
+// Runs the refresh timer of LVGL at a vertical blanking period of the panel instead of free running
+void frame_sync(lv_timer_t *timer)
+{
+  static uint32_t last_frame_count, last_refresh_frame_count;
+  lcd_te_info_t info;
+  if (lcd_te_get_info(&info) != ESP_OK)
+    return;
+
+#if SMARTDISPLAY_FRAME_SYNC_POLL_MS == 0
+  uint32_t poll_ms = LV_MAX(info.period_us / 4000, 1);
+#endif
+  if (info.frame_count != last_frame_count)
+  {
+    last_frame_count = info.frame_count;
+    const smartdisplay_t *smartdisplay = timer->user_data;
+    lv_display_send_event(smartdisplay->display, smartdisplay_event_frame_sync, &info);
+
+    // Refresh every n panel frames, the closest to the refresh period of the display
+    uint32_t frames = info.period_us > 0 ? LV_MAX((smartdisplay->refresh_period_ms * 1000 + info.period_us / 2) / info.period_us, 1) : 1;
+    if (info.frame_count - last_refresh_frame_count >= frames)
+    {
+      last_refresh_frame_count = info.frame_count;
+      lv_timer_ready(smartdisplay->display->refr_timer);
+#if SMARTDISPLAY_FRAME_SYNC_POLL_MS == 0
+      // Nothing to do until a quarter period before the frame of the next refresh
+      const int64_t wait_us = info.last_vblank_us + (int64_t)frames * info.period_us - info.period_us / 4 - esp_timer_get_time();
+      poll_ms = LV_MAX(wait_us / 1000, poll_ms);
+#endif
+    }
+  }
+
+#if SMARTDISPLAY_FRAME_SYNC_POLL_MS == 0
+  lv_timer_set_period(timer, poll_ms);
+#endif
+}
+#endif
+
+void power_policy_render_start(lv_event_t *event)
+{
+  power_policy_last_render = lv_tick_get();
+  // Leave the low power state before the pixels are sent
+  if (power_policy_idle)
+  {
+    power_policy_idle = false;
+    power_policy_cb(false);
+  }
+}
+
+void power_policy_check(lv_timer_t *timer)
+{
+  if (!power_policy_idle && lv_tick_elaps(power_policy_last_render) >= power_policy_idle_ms)
+  {
+    log_d("Nothing rendered for %d ms, entering low power", power_policy_idle_ms);
+    power_policy_idle = true;
+    power_policy_cb(true);
+  }
+}
+
+void smartdisplay_lcd_set_power_policy_cb(smartdisplay_lcd_power_policy_cb_t cb, uint32_t idle_ms)
+{
+  log_v("power_policy_cb:0x%08x, idle_ms:%u", cb, idle_ms);
+
+  // Remove current policy if any, leaving the low power state
+  if (power_policy_timer != NULL)
+  {
+    lv_timer_del(power_policy_timer);
+    power_policy_timer = NULL;
+    lv_display_remove_event_cb_with_user_data(display, power_policy_render_start, NULL);
+    if (power_policy_idle)
+    {
+      power_policy_idle = false;
+      power_policy_cb(false);
+    }
+  }
+
+  power_policy_cb = cb;
+  power_policy_idle_ms = idle_ms;
+  if (cb != NULL && idle_ms > 0)
+  {
+    power_policy_last_render = lv_tick_get();
+    lv_display_add_event_cb(display, power_policy_render_start, LV_EVENT_RENDER_START, NULL);
+    power_policy_timer = lv_timer_create(power_policy_check, LV_MAX(idle_ms / 4, 1), NULL);
+  }
+}
+
+#ifdef SMARTDISPLAY_DCS_PANEL
+void smartdisplay_lcd_power_policy_dcs(bool idle)
+{
+  log_v("idle:%d", idle);
+
+  const esp_lcd_panel_handle_t panel_handle = display->user_data;
+  // The commands must not be interleaved with the pixels of a pending transfer
+  smartdisplay_dma_wait_all_done(panel_handle, SMARTDISPLAY_DMA_TIMEOUT_MS);
+  // The whole display is shown again before the other settings are restored
+  if (!idle && power_policy_partial_height > 0)
+    esp_lcd_panel_dcs_set_partial_area(panel_handle, 0, 0);
+#ifdef SMARTDISPLAY_DCS_FRAME_RATE
+  esp_lcd_panel_dcs_set_frame_rate(panel_handle, idle ? SMARTDISPLAY_IDLE_FRAME_RATE : 0);
+#endif
+#ifdef SMARTDISPLAY_IDLE_8_COLORS
+  esp_lcd_panel_dcs_set_idle_mode(panel_handle, idle);
+#endif
+  if (idle && power_policy_partial_height > 0)
+    esp_lcd_panel_dcs_set_partial_area(panel_handle, power_policy_partial_y, power_policy_partial_height);
+}
+
+void smartdisplay_lcd_power_policy_dcs_set_partial_area(int y, int height)
+{
+  log_v("y:%d, height:%d", y, height);
+  if (y < 0 || height < 0)
+    return;
+
+  // Applied when entering the low power state, a change while idle is applied at once
+  const bool idle = power_policy_idle && power_policy_cb == smartdisplay_lcd_power_policy_dcs;
+  if (idle && power_policy_partial_height > 0 && height == 0)
+  {
+    smartdisplay_dma_wait_all_done(display->user_data, SMARTDISPLAY_DMA_TIMEOUT_MS);
+    esp_lcd_panel_dcs_set_partial_area(display->user_data, 0, 0);
+  }
+
+  power_policy_partial_y = y;
+  power_policy_partial_height = height;
+  if (idle && height > 0)
+  {
+    smartdisplay_dma_wait_all_done(display->user_data, SMARTDISPLAY_DMA_TIMEOUT_MS);
+    esp_lcd_panel_dcs_set_partial_area(display->user_data, y, height);
+  }
+}
+#endif
+
 #ifdef BOARD_HAS_RGB_LED
 void smartdisplay_led_set_rgb(bool r, bool g, bool b)
 {
@@ -156,9 +532,54 @@ touch_calibration_data_t smartdisplay_compute_touch_calibration(const lv_point_t
 };
 #endif
 
+void smartdisplay_lcd_set_buffers(lv_display_t *display, const smartdisplay_config_t *config)
+{
+  log_v("display:0x%08x, config:0x%08x", display, config);
+
+  lv_display_render_mode_t render_mode = config->render_mode;
+  if (render_mode == LV_DISPLAY_RENDER_MODE_DIRECT)
+  {
+    // Direct mode needs the panel framebuffers, only available on RGB panels with SMARTDISPLAY_RGB_DIRECT_MODE
+    log_w("Direct render mode is not supported by this display, using partial mode");
+    render_mode = LV_DISPLAY_RENDER_MODE_PARTIAL;
+  }
+
+  uint32_t buffer_pixels;
+  if (render_mode == LV_DISPLAY_RENDER_MODE_FULL)
+    buffer_pixels = display->hor_res * display->ver_res;
+  else if (config->buffer_lines > 0)
+    // Lines of the longest side so the band fits in every rotation
+    buffer_pixels = LV_MAX(display->hor_res, display->ver_res) * config->buffer_lines;
+  else
+    buffer_pixels = config->buffer_pixels;
+
+  const uint32_t px_size = lv_color_format_get_size(lv_display_get_color_format(display));
+  const uint32_t drawBufferSize = px_size * buffer_pixels;
+  void *drawBuffer1 = heap_caps_malloc(drawBufferSize, config->buffer_malloc_flags);
+  if (drawBuffer1 == NULL)
+  {
+    log_e("Unable to allocate draw buffer of %d bytes", drawBufferSize);
+    return;
+  }
+
+  void *drawBuffer2 = NULL;
+  if (config->buffer_count > 1 && (drawBuffer2 = heap_caps_malloc(drawBufferSize, config->buffer_malloc_flags)) == NULL)
+    log_w("Unable to allocate second draw buffer of %d bytes, using a single buffer", drawBufferSize);
+
+  log_d("draw buffers: 0x%08x, 0x%08x (%d bytes), render_mode:%d", drawBuffer1, drawBuffer2, drawBufferSize, render_mode);
+  lv_display_set_buffers(display, drawBuffer1, drawBuffer2, drawBufferSize, render_mode);
+}
+
 void smartdisplay_init()
+{
+  const smartdisplay_config_t config = SMARTDISPLAY_CONFIG_DEFAULT();
+  smartdisplay_init_with_config(&config);
+}
+
+void smartdisplay_init_with_config(const smartdisplay_config_t *config)
 {
   log_d("smartdisplay_init");
+  log_v("config:0x%08x", config);
 #ifdef BOARD_HAS_RGB_LED
   // Setup RGB LED.  High is off
   pinMode(RGB_LED_R, OUTPUT);
@@ -196,12 +617,33 @@ void smartdisplay_init()
   ledcSetup(PWM_CHANNEL_BCKL, PWM_FREQ_BCKL, PWM_BITS_BCKL);
   ledcAttachPin(DISPLAY_BCKL, PWM_CHANNEL_BCKL);
 #endif
-  // Setup TFT display
-  display = lvgl_lcd_init();
+  // Setup TFT display, the orientation of the board display is set by the board definition
+  smartdisplay_config_t board_config = *config;
+#if defined(SMARTDISPLAY_RGB_PANEL) && defined(SMARTDISPLAY_RGB_BLIT) && !defined(SMARTDISPLAY_RGB_DIRECT_MODE)
+  // The blit flush rotates into the framebuffer itself, the panel transform is never used
+  board_config.hw_rotation = (smartdisplay_hw_rotation_t){.enabled = false};
+#else
+  board_config.hw_rotation = (smartdisplay_hw_rotation_t)SMARTDISPLAY_HW_ROTATION_DEFAULT();
+#endif
+  smartdisplay_t *smartdisplay = smartdisplay_add_display(lvgl_lcd_init, &board_config);
+  if (smartdisplay == NULL)
+  {
+    log_e("Board display initialization failed");
+    return;
+  }
 
-#ifndef DISPLAY_SOFTWARE_ROTATION
-  // Register callback for hardware rotation
-  lv_display_add_event_cb(display, lvgl_display_resolution_changed_callback, LV_EVENT_RESOLUTION_CHANGED, NULL);
+  display = smartdisplay->display;
+  lcd_boot_profile_log();
+
+#ifdef DISPLAY_TE
+  smartdisplay_event_frame_sync = lv_event_register_id();
+  if (lcd_te_enabled())
+  {
+    // Refresh on TE
+    smartdisplay->frame_sync = true;
+    smartdisplay_set_refresh_period(smartdisplay, smartdisplay->refresh_period_ms);
+    frame_sync_timer = lv_timer_create(frame_sync, LV_MAX(SMARTDISPLAY_FRAME_SYNC_POLL_MS, 1), smartdisplay);
+  }
 #endif
 
   //  Clear screen
@@ -221,33 +663,86 @@ void smartdisplay_init()
 #endif
 }
 
-#ifndef DISPLAY_SOFTWARE_ROTATION
+smartdisplay_t *smartdisplay_add_display(smartdisplay_lcd_init_cb_t lcd_init, const smartdisplay_config_t *config)
+{
+  log_v("lcd_init:0x%08x, config:0x%08x", lcd_init, config);
+  if (lcd_init == NULL || config == NULL)
+    return NULL;
+
+  if (smartdisplay_count == SMARTDISPLAY_MAX_DISPLAYS)
+  {
+    log_e("No display left, increase SMARTDISPLAY_MAX_DISPLAYS");
+    return NULL;
+  }
+
+  // The state of the library panel driver belongs to the board display
+  if (lcd_init == lvgl_lcd_init && smartdisplay_count > 0)
+  {
+    log_e("The panel driver of the board can only be used once");
+    return NULL;
+  }
+
+  lv_display_t *lv_display = lcd_init(config);
+  if (lv_display == NULL)
+  {
+    log_e("Display initialization failed");
+    return NULL;
+  }
+
+  smartdisplay_t *smartdisplay = &smartdisplays[smartdisplay_count++];
+  *smartdisplay = (smartdisplay_t){.display = lv_display, .hw_rotation = config->hw_rotation};
+  smartdisplay_set_refresh_period(smartdisplay, config->refresh_period_ms);
+  // Every display has its own orientation, the event carries the display
+  if (smartdisplay->hw_rotation.enabled)
+    lv_display_add_event_cb(lv_display, lvgl_display_resolution_changed_callback, LV_EVENT_RESOLUTION_CHANGED, smartdisplay);
+
+  return smartdisplay;
+}
+
+smartdisplay_t *smartdisplay_get_default()
+{
+  return smartdisplay_count > 0 ? &smartdisplays[0] : NULL;
+}
+
+lv_display_t *smartdisplay_get_lv_display(const smartdisplay_t *smartdisplay)
+{
+  return smartdisplay != NULL ? smartdisplay->display : NULL;
+}
+
+void smartdisplay_set_refresh_period(smartdisplay_t *smartdisplay, uint32_t period_ms)
+{
+  log_v("smartdisplay:0x%08x, period_ms:%d", smartdisplay, period_ms);
+  smartdisplay->refresh_period_ms = period_ms > 0 ? period_ms : LV_DEF_REFR_PERIOD;
+  // With frame sync the refresh timer itself only runs if the TE signal is lost
+  lv_timer_set_period(smartdisplay->display->refr_timer, smartdisplay->frame_sync ? 2 * smartdisplay->refresh_period_ms : smartdisplay->refresh_period_ms);
+}
+
 // Called when driver resolution is updated (including rotation)
 // Top of the display is top left when connector is at the bottom
 // The rotation values are relative to how you would rotate the physical display in the clockwise direction.
 // So, LV_DISPLAY_ROTATION_90 means you rotate the hardware 90 degrees clockwise, and the display rotates 90 degrees counterclockwise to compensate.
 void lvgl_display_resolution_changed_callback(lv_event_t *event)
 {
+  const lv_display_t *display = lv_event_get_target(event);
+  const smartdisplay_hw_rotation_t *hw_rotation = &((const smartdisplay_t *)lv_event_get_user_data(event))->hw_rotation;
   const esp_lcd_panel_handle_t panel_handle = display->user_data;
   switch (display->rotation)
   {
   case LV_DISPLAY_ROTATION_0:
-    ESP_ERROR_CHECK(esp_lcd_panel_swap_xy(panel_handle, DISPLAY_SWAP_XY));
-    ESP_ERROR_CHECK(esp_lcd_panel_mirror(panel_handle, DISPLAY_MIRROR_X, DISPLAY_MIRROR_Y));
+    ESP_ERROR_CHECK(esp_lcd_panel_swap_xy(panel_handle, hw_rotation->swap_xy));
+    ESP_ERROR_CHECK(esp_lcd_panel_mirror(panel_handle, hw_rotation->mirror_x, hw_rotation->mirror_y));
     break;
   case LV_DISPLAY_ROTATION_90:
-    ESP_ERROR_CHECK(esp_lcd_panel_swap_xy(panel_handle, !DISPLAY_SWAP_XY));
-    ESP_ERROR_CHECK(esp_lcd_panel_mirror(panel_handle, DISPLAY_MIRROR_X, !DISPLAY_MIRROR_Y));
+    ESP_ERROR_CHECK(esp_lcd_panel_swap_xy(panel_handle, !hw_rotation->swap_xy));
+    ESP_ERROR_CHECK(esp_lcd_panel_mirror(panel_handle, hw_rotation->mirror_x, !hw_rotation->mirror_y));
     break;
   case LV_DISPLAY_ROTATION_180:
-    ESP_ERROR_CHECK(esp_lcd_panel_swap_xy(panel_handle, DISPLAY_SWAP_XY));
-    ESP_ERROR_CHECK(esp_lcd_panel_mirror(panel_handle, !DISPLAY_MIRROR_X, !DISPLAY_MIRROR_Y));
+    ESP_ERROR_CHECK(esp_lcd_panel_swap_xy(panel_handle, hw_rotation->swap_xy));
+    ESP_ERROR_CHECK(esp_lcd_panel_mirror(panel_handle, !hw_rotation->mirror_x, !hw_rotation->mirror_y));
     break;
   case LV_DISPLAY_ROTATION_270:
-    ESP_ERROR_CHECK(esp_lcd_panel_swap_xy(panel_handle, !DISPLAY_SWAP_XY));
-    ESP_ERROR_CHECK(esp_lcd_panel_mirror(panel_handle, !DISPLAY_MIRROR_X, DISPLAY_MIRROR_Y));
+    ESP_ERROR_CHECK(esp_lcd_panel_swap_xy(panel_handle, !hw_rotation->swap_xy));
+    ESP_ERROR_CHECK(esp_lcd_panel_mirror(panel_handle, !hw_rotation->mirror_x, hw_rotation->mirror_y));
     break;
   }
 }
-
-#endif
@@ -1,24 +1,92 @@
 #include <esp32_smartdisplay_dma.h>
 #include <esp32-hal-log.h>
+#include <esp_attr.h>
 #include <esp_heap_caps.h>
+#include <esp_timer.h>
 #include <esp_lcd_panel_io.h>
+#include <esp_lcd.h>
 #include <string.h>
 
-// Global DMA manager instance
-static smartdisplay_dma_manager_t *g_dma_manager = NULL;
+// Maximum wait for the start of the vertical blanking period when TE is enabled
+#ifndef SMARTDISPLAY_TE_TIMEOUT_MS
+#define SMARTDISPLAY_TE_TIMEOUT_MS 50
+#endif
+
+#ifndef SMARTDISPLAY_DMA_BENCHMARK_INTERVAL_MS
+#define SMARTDISPLAY_DMA_BENCHMARK_INTERVAL_MS 1000
+#endif
+
+// DMA managers, one per panel
+static smartdisplay_dma_manager_t *g_dma_managers[SMARTDISPLAY_DMA_MAX_PANELS];
 
 #ifndef _min
 #define _min(a, b) ((a) < (b) ? (a) : (b))
 #endif
 
-bool smartdisplay_dma_should_use_dma(size_t data_len)
+// Manager of a panel, NULL if it has none
+static smartdisplay_dma_manager_t *smartdisplay_dma_get(esp_lcd_panel_handle_t panel_handle)
+{
+    for (int i = 0; i < SMARTDISPLAY_DMA_MAX_PANELS; i++)
+        if (g_dma_managers[i] != NULL && g_dma_managers[i]->panel_handle == panel_handle)
+            return g_dma_managers[i];
+
+    return NULL;
+}
+
+// Every completion of a tracked panel releases a staging buffer, a direct draw would release one the worker still uses
+static bool smartdisplay_dma_tracked(const smartdisplay_dma_manager_t *m)
+{
+    return m->staging_free != NULL;
+}
+
+static esp_err_t smartdisplay_dma_queue_transfer(smartdisplay_dma_manager_t *m, const smartdisplay_dma_transfer_t *transfer)
+{
+    // Count the transfer before the worker can pick it up
+    if (xSemaphoreTake(m->state_mutex, pdMS_TO_TICKS(10)) == pdTRUE)
+    {
+        m->active_transfers++;
+        xSemaphoreGive(m->state_mutex);
+    }
+
+    // A tracked panel cannot fall back to a direct draw, wait for room in the queue
+    const TickType_t wait = smartdisplay_dma_tracked(m) ? pdMS_TO_TICKS(SMARTDISPLAY_DMA_TIMEOUT_MS) : 0;
+    const BaseType_t queue_result = transfer->high_priority ? xQueueSendToFront(m->transfer_queue, transfer, wait) : xQueueSend(m->transfer_queue, transfer, wait);
+    if (queue_result != pdPASS)
+    {
+        if (xSemaphoreTake(m->state_mutex, pdMS_TO_TICKS(10)) == pdTRUE)
+        {
+            m->active_transfers--;
+            xSemaphoreGive(m->state_mutex);
+        }
+
+        return ESP_ERR_TIMEOUT;
+    }
+
+    return ESP_OK;
+}
+
+// Bytes of pixel data, RGB444 packs two pixels in three bytes
+static size_t smartdisplay_dma_data_len(const smartdisplay_dma_manager_t *m, size_t pixels)
 {
-    return g_dma_manager != NULL && data_len >= SMARTDISPLAY_DMA_CHUNK_THRESHOLD;
+    return (pixels * m->bits_per_pixel + 7) / 8;
 }
 
-esp_err_t smartdisplay_dma_draw_bitmap(int x_start, int y_start, int x_end, int y_end, const void *color_data, smartdisplay_dma_callback_t callback, void *user_data, bool high_priority)
+bool smartdisplay_dma_should_use_dma(esp_lcd_panel_handle_t panel_handle, size_t data_len)
 {
-    if (g_dma_manager == NULL)
+    const smartdisplay_dma_manager_t *m = smartdisplay_dma_get(panel_handle);
+    return m != NULL && (data_len >= SMARTDISPLAY_DMA_CHUNK_THRESHOLD || smartdisplay_dma_tracked(m));
+}
+
+bool smartdisplay_dma_is_tracked(esp_lcd_panel_handle_t panel_handle)
+{
+    const smartdisplay_dma_manager_t *m = smartdisplay_dma_get(panel_handle);
+    return m != NULL && smartdisplay_dma_tracked(m);
+}
+
+esp_err_t smartdisplay_dma_draw_bitmap(esp_lcd_panel_handle_t panel_handle, int x_start, int y_start, int x_end, int y_end, const void *color_data, smartdisplay_dma_callback_t callback, void *user_data, bool high_priority)
+{
+    smartdisplay_dma_manager_t *m = smartdisplay_dma_get(panel_handle);
+    if (m == NULL)
     {
         log_e("DMA manager not initialized");
         return ESP_ERR_INVALID_STATE;
@@ -33,12 +101,12 @@ esp_err_t smartdisplay_dma_draw_bitmap(int x_start, int y_start, int x_end, int
     // Calculate transfer size
     const size_t width = x_end - x_start;
     const size_t height = y_end - y_start;
-    const size_t data_len = width * height * sizeof(uint16_t); // Assuming RGB565
+    const size_t data_len = smartdisplay_dma_data_len(m, width * height);
 
     // For small transfers, use direct transfer
-    if (!smartdisplay_dma_should_use_dma(data_len))
+    if (data_len < SMARTDISPLAY_DMA_CHUNK_THRESHOLD && !smartdisplay_dma_tracked(m))
     {
-        const esp_err_t ret = esp_lcd_panel_draw_bitmap(g_dma_manager->panel_handle, x_start, y_start, x_end, y_end, color_data);
+        const esp_err_t ret = esp_lcd_panel_draw_bitmap(m->panel_handle, x_start, y_start, x_end, y_end, color_data);
         if (callback != NULL)
             callback(ret == ESP_OK, user_data);
 
@@ -58,41 +126,107 @@ esp_err_t smartdisplay_dma_draw_bitmap(int x_start, int y_start, int x_end, int
         .high_priority = high_priority};
 
     // Queue transfer
-    const BaseType_t queue_result = high_priority ? xQueueSendToFront(g_dma_manager->transfer_queue, &transfer, 0) : xQueueSend(g_dma_manager->transfer_queue, &transfer, 0);
-    if (queue_result != pdPASS)
+    if (smartdisplay_dma_queue_transfer(m, &transfer) != ESP_OK)
     {
+        if (smartdisplay_dma_tracked(m))
+        {
+            log_e("Transfer queue full");
+            return ESP_ERR_TIMEOUT;
+        }
+
         log_w("Transfer queue full, falling back to direct transfer");
-        esp_err_t ret = esp_lcd_panel_draw_bitmap(g_dma_manager->panel_handle, x_start, y_start, x_end, y_end, color_data);
+        esp_err_t ret = esp_lcd_panel_draw_bitmap(m->panel_handle, x_start, y_start, x_end, y_end, color_data);
         if (callback != NULL)
             callback(ret == ESP_OK, user_data);
 
         return ret;
     }
 
-    // Update statistics
-    if (xSemaphoreTake(g_dma_manager->state_mutex, pdMS_TO_TICKS(10)) == pdTRUE)
+    return ESP_OK;
+}
+
+esp_err_t smartdisplay_dma_queue_bitmap(esp_lcd_panel_handle_t panel_handle, int x_start, int y_start, int x_end, int y_end, const void *color_data, smartdisplay_dma_callback_t callback, void *user_data, bool high_priority)
+{
+    smartdisplay_dma_manager_t *m = smartdisplay_dma_get(panel_handle);
+    if (m == NULL)
+        return ESP_ERR_INVALID_STATE;
+
+    if (color_data == NULL)
     {
-        g_dma_manager->active_transfers++;
-        xSemaphoreGive(g_dma_manager->state_mutex);
+        log_e("Invalid color data");
+        return ESP_ERR_INVALID_ARG;
     }
 
-    return ESP_OK;
+    const smartdisplay_dma_transfer_t transfer = {
+        .src_data = color_data,
+        .data_len = smartdisplay_dma_data_len(m, (x_end - x_start) * (y_end - y_start)),
+        .x_start = x_start,
+        .y_start = y_start,
+        .x_end = x_end,
+        .y_end = y_end,
+        .callback = callback,
+        .user_data = user_data,
+        .high_priority = high_priority};
+
+    return smartdisplay_dma_queue_transfer(m, &transfer);
 }
 
-esp_err_t smartdisplay_dma_wait_all_done(uint32_t timeout_ms)
+esp_err_t smartdisplay_dma_draw_bitmap_rotated(esp_lcd_panel_handle_t panel_handle, int x_start, int y_start, int x_end, int y_end, const void *src_data, int32_t src_width, int32_t src_height, uint32_t src_stride, lv_display_rotation_t rotation, smartdisplay_dma_callback_t callback, void *user_data, bool high_priority)
 {
-    if (g_dma_manager == NULL)
+    smartdisplay_dma_manager_t *m = smartdisplay_dma_get(panel_handle);
+    if (m == NULL)
         return ESP_ERR_INVALID_STATE;
 
+    if (src_data == NULL)
+    {
+        log_e("Invalid color data");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (m->bits_per_pixel != 16)
+    {
+        log_e("Rotation is only supported for RGB565");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    const size_t width = x_end - x_start;
+    const size_t height = y_end - y_start;
+    const size_t bytes_per_row = width * sizeof(uint16_t); // RGB565
+    if (bytes_per_row > m->dma_buffer_size)
+    {
+        log_e("Row size (%d) exceeds DMA buffer size (%d)", bytes_per_row, m->dma_buffer_size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const smartdisplay_dma_transfer_t transfer = {
+        .src_data = src_data,
+        .data_len = bytes_per_row * height,
+        .x_start = x_start,
+        .y_start = y_start,
+        .x_end = x_end,
+        .y_end = y_end,
+        .callback = callback,
+        .user_data = user_data,
+        .high_priority = high_priority,
+        .rotation = rotation,
+        .src_width = src_width,
+        .src_height = src_height,
+        .src_stride = src_stride};
+
+    return smartdisplay_dma_queue_transfer(m, &transfer);
+}
+
+static esp_err_t smartdisplay_dma_wait_idle(smartdisplay_dma_manager_t *m, uint32_t timeout_ms)
+{
     const uint32_t start_time = xTaskGetTickCount();
     const uint32_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
 
     while ((xTaskGetTickCount() - start_time) < timeout_ticks)
     {
-        if (xSemaphoreTake(g_dma_manager->state_mutex, pdMS_TO_TICKS(10)) == pdTRUE)
+        if (xSemaphoreTake(m->state_mutex, pdMS_TO_TICKS(10)) == pdTRUE)
         {
-            const bool all_done = (g_dma_manager->active_transfers == 0 && uxQueueMessagesWaiting(g_dma_manager->transfer_queue) == 0);
-            xSemaphoreGive(g_dma_manager->state_mutex);
+            const bool all_done = (m->active_transfers == 0 && uxQueueMessagesWaiting(m->transfer_queue) == 0);
+            xSemaphoreGive(m->state_mutex);
 
             if (all_done)
                 return ESP_OK;
@@ -104,24 +238,34 @@ esp_err_t smartdisplay_dma_wait_all_done(uint32_t timeout_ms)
     return ESP_ERR_TIMEOUT;
 }
 
-esp_err_t smartdisplay_dma_get_stats(uint32_t *active_transfers, uint32_t *completed_transfers, uint32_t *failed_transfers)
+esp_err_t smartdisplay_dma_wait_all_done(esp_lcd_panel_handle_t panel_handle, uint32_t timeout_ms)
 {
-    if (g_dma_manager == NULL)
+    smartdisplay_dma_manager_t *m = smartdisplay_dma_get(panel_handle);
+    if (m == NULL)
         return ESP_ERR_INVALID_STATE;
 
-    if (xSemaphoreTake(g_dma_manager->state_mutex, pdMS_TO_TICKS(100)) != pdTRUE)
+    return smartdisplay_dma_wait_idle(m, timeout_ms);
+}
+
+esp_err_t smartdisplay_dma_get_stats(esp_lcd_panel_handle_t panel_handle, uint32_t *active_transfers, uint32_t *completed_transfers, uint32_t *failed_transfers)
+{
+    smartdisplay_dma_manager_t *m = smartdisplay_dma_get(panel_handle);
+    if (m == NULL)
+        return ESP_ERR_INVALID_STATE;
+
+    if (xSemaphoreTake(m->state_mutex, pdMS_TO_TICKS(100)) != pdTRUE)
         return ESP_ERR_TIMEOUT;
 
     if (active_transfers)
-        *active_transfers = g_dma_manager->active_transfers;
+        *active_transfers = m->active_transfers;
 
     if (completed_transfers)
-        *completed_transfers = g_dma_manager->completed_transfers;
+        *completed_transfers = m->completed_transfers;
 
     if (failed_transfers)
-        *failed_transfers = g_dma_manager->failed_transfers;
+        *failed_transfers = m->failed_transfers;
 
-    xSemaphoreGive(g_dma_manager->state_mutex);
+    xSemaphoreGive(m->state_mutex);
     return ESP_OK;
 }
 
@@ -138,10 +282,10 @@ static void lvgl_dma_callback(bool success, void *user_data)
 
 void smartdisplay_dma_lvgl_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
 {
-    if (g_dma_manager == NULL)
+    // Fallback to default flush using panel handle from display user data
+    esp_lcd_panel_handle_t panel = (esp_lcd_panel_handle_t)lv_display_get_user_data(display);
+    if (smartdisplay_dma_get(panel) == NULL)
     {
-        // Fallback to default flush using panel handle from display user data
-        esp_lcd_panel_handle_t panel = (esp_lcd_panel_handle_t)lv_display_get_user_data(display);
         if (panel)
             esp_lcd_panel_draw_bitmap(panel, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map);
 
@@ -150,26 +294,25 @@ void smartdisplay_dma_lvgl_flush(lv_display_t *display, const lv_area_t *area, u
     }
 
     // Queue DMA transfer - pass display pointer directly as user data. No byte order is swapped for SPI
-    esp_err_t ret = smartdisplay_dma_draw_bitmap(area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map, lvgl_dma_callback, display, false);
+    esp_err_t ret = smartdisplay_dma_draw_bitmap(panel, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map, lvgl_dma_callback, display, false);
     if (ret != ESP_OK)
     {
         log_w("Failed to queue DMA transfer, using direct transfer");
-        esp_lcd_panel_handle_t panel = (esp_lcd_panel_handle_t)lv_display_get_user_data(display);
-        if (panel)
+        if (!smartdisplay_dma_is_tracked(panel))
             esp_lcd_panel_draw_bitmap(panel, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map);
 
         lv_display_flush_ready(display);
     }
 }
 
-static esp_err_t smartdisplay_dma_copy_to_buffer(const void *src, size_t len, void **dest)
+static esp_err_t smartdisplay_dma_copy_to_buffer(smartdisplay_dma_manager_t *m, const void *src, size_t len, void *buffer, void **dest)
 {
     if (src == NULL || len == 0 || dest == NULL)
         return ESP_ERR_INVALID_ARG;
 
-    if (len > g_dma_manager->dma_buffer_size)
+    if (len > m->dma_buffer_size)
     {
-        log_e("Data size (%d) exceeds DMA buffer size (%d)", len, g_dma_manager->dma_buffer_size);
+        log_e("Data size (%d) exceeds DMA buffer size (%d)", len, m->dma_buffer_size);
         return ESP_ERR_INVALID_SIZE;
     }
 
@@ -181,13 +324,87 @@ static esp_err_t smartdisplay_dma_copy_to_buffer(const void *src, size_t len, vo
     }
 
     // Copy to DMA buffer
-    memcpy(g_dma_manager->dma_buffer, src, len);
-    *dest = g_dma_manager->dma_buffer;
+    memcpy(buffer, src, len);
+    *dest = buffer;
+
+    return ESP_OK;
+}
+
+static esp_err_t smartdisplay_dma_rotate_to_buffer(const smartdisplay_dma_transfer_t *transfer, int32_t row, int32_t rows, void *buffer, void **dest)
+{
+    // Rows [row, row + rows) of the rotated output come from a sub rectangle of the source
+    const size_t bytes_per_pixel = sizeof(uint16_t); // RGB565
+    const uint8_t *src = (const uint8_t *)transfer->src_data;
+    int32_t src_width = transfer->src_width;
+    int32_t src_height = transfer->src_height;
+    switch (transfer->rotation)
+    {
+    case LV_DISPLAY_ROTATION_90:
+        // Output row r is source column (width - 1 - r)
+        src += (src_width - row - rows) * bytes_per_pixel;
+        src_width = rows;
+        break;
+    case LV_DISPLAY_ROTATION_180:
+        // Output row r is source row (height - 1 - r)
+        src += (src_height - row - rows) * transfer->src_stride;
+        src_height = rows;
+        break;
+    case LV_DISPLAY_ROTATION_270:
+        // Output row r is source column r
+        src += row * bytes_per_pixel;
+        src_width = rows;
+        break;
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const uint32_t dest_stride = (transfer->x_end - transfer->x_start) * bytes_per_pixel;
+    lv_draw_sw_rotate(src, buffer, src_width, src_height, transfer->src_stride, dest_stride, transfer->rotation, LV_COLOR_FORMAT_RGB565);
+    *dest = buffer;
 
     return ESP_OK;
 }
 
-static esp_err_t smartdisplay_dma_transfer_chunk(const smartdisplay_dma_transfer_t *transfer)
+// Wait until all the staging buffers have been sent
+static esp_err_t smartdisplay_dma_wait_staging_free(smartdisplay_dma_manager_t *m)
+{
+    UBaseType_t taken = 0;
+    while (taken < SMARTDISPLAY_DMA_INFLIGHT_TRANSFERS && xSemaphoreTake(m->staging_free, pdMS_TO_TICKS(SMARTDISPLAY_DMA_TIMEOUT_MS)) == pdTRUE)
+        taken++;
+
+    for (UBaseType_t i = 0; i < taken; i++)
+        xSemaphoreGive(m->staging_free);
+
+    return taken == SMARTDISPLAY_DMA_INFLIGHT_TRANSFERS ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+// Wait for the start of the vertical blanking period. Without recent TE edges the transfer is not delayed,
+// it is synchronized again once the signal is back
+static void smartdisplay_dma_wait_vblank(smartdisplay_dma_manager_t *m)
+{
+    lcd_te_info_t info;
+    if (lcd_te_get_info(&info) != ESP_OK)
+        return;
+
+    if (esp_timer_get_time() - info.last_vblank_us < SMARTDISPLAY_TE_TIMEOUT_MS * 1000LL && lcd_te_wait_vblank(SMARTDISPLAY_TE_TIMEOUT_MS) == ESP_OK)
+    {
+        if (m->te_lost)
+        {
+            log_i("TE signal is back, transfers are synchronized again");
+            m->te_lost = false;
+        }
+
+        return;
+    }
+
+    if (!m->te_lost)
+    {
+        log_w("No TE signal, transfers are not synchronized until it is back");
+        m->te_lost = true;
+    }
+}
+
+static esp_err_t smartdisplay_dma_transfer_chunk(smartdisplay_dma_manager_t *m, const smartdisplay_dma_transfer_t *transfer)
 {
     if (transfer == NULL || transfer->src_data == NULL)
         return ESP_ERR_INVALID_ARG;
@@ -195,33 +412,69 @@ static esp_err_t smartdisplay_dma_transfer_chunk(const smartdisplay_dma_transfer
     size_t remaining = transfer->data_len;
     const uint8_t *src_ptr = (const uint8_t *)transfer->src_data;
     const size_t pixels_per_row = transfer->x_end - transfer->x_start;
-    const size_t bytes_per_pixel = sizeof(uint16_t); // RGB565
-    const size_t bytes_per_row = pixels_per_row * bytes_per_pixel;
+    const size_t bits_per_row = pixels_per_row * m->bits_per_pixel;
+    // With RGB444 an odd width row ends halfway a byte, chunks are then split on even rows
+    const size_t row_align = (bits_per_row & 0x7) ? 2 : 1;
+
+    // With TE, a transfer from the top row starts at vblank and the next bands follow the scanline down.
+    // Only the transfers of the worker are synchronized, the direct draws of untracked panels are not
+    if (transfer->y_start == 0 && m->te_sync)
+        smartdisplay_dma_wait_vblank(m);
 
     int current_y = transfer->y_start;
     while (remaining > 0 && current_y < transfer->y_end)
     {
         // Calculate chunk size (limit to DMA buffer size)
-        size_t chunk_rows = _min(remaining / bytes_per_row, g_dma_manager->dma_buffer_size / bytes_per_row);
+        size_t chunk_rows = _min((size_t)(transfer->y_end - current_y), m->dma_buffer_size * 8 / bits_per_row);
+        if (chunk_rows < (size_t)(transfer->y_end - current_y))
+            chunk_rows -= chunk_rows % row_align;
+
+        // A chunk must fit in the staging buffer, an RGB444 row of odd width is only sent with the next one
         if (chunk_rows == 0)
-            chunk_rows = 1; // At least one row
+        {
+            log_e("%d rows of %d pixels exceed the DMA buffer size (%d)", row_align, pixels_per_row, m->dma_buffer_size);
+            return ESP_ERR_INVALID_SIZE;
+        }
 
-        const size_t chunk_size = _min(chunk_rows * bytes_per_row, remaining);
-        // Copy data to DMA buffer
+        const size_t chunk_size = _min((chunk_rows * bits_per_row + 7) / 8, remaining);
+        // With tracked completion, take the next staging buffer once it has been sent
+        void *buffer = m->dma_buffer;
+        if (m->staging_free != NULL)
+        {
+            if (xSemaphoreTake(m->staging_free, pdMS_TO_TICKS(SMARTDISPLAY_DMA_TIMEOUT_MS)) != pdTRUE)
+            {
+                log_e("Staging buffer not sent in time");
+                return ESP_ERR_TIMEOUT;
+            }
+
+            buffer = m->staging_buffers[m->next_staging_buffer];
+            m->next_staging_buffer = (m->next_staging_buffer + 1) % SMARTDISPLAY_DMA_INFLIGHT_TRANSFERS;
+        }
+
+        // Copy (or rotate) data to DMA buffer
         void *dma_data;
-        const esp_err_t copy_result = smartdisplay_dma_copy_to_buffer(src_ptr, chunk_size, &dma_data);
+        const esp_err_t copy_result = transfer->rotation == LV_DISPLAY_ROTATION_0
+                                          ? smartdisplay_dma_copy_to_buffer(m, src_ptr, chunk_size, buffer, &dma_data)
+                                          : smartdisplay_dma_rotate_to_buffer(transfer, current_y - transfer->y_start, chunk_rows, buffer, &dma_data);
         if (copy_result != ESP_OK)
         {
             log_e("Failed to copy data to DMA buffer");
+            if (m->staging_free != NULL)
+                xSemaphoreGive(m->staging_free);
+
             return copy_result;
         }
 
         // Perform DMA transfer
         const int chunk_y_end = current_y + chunk_rows;
-        const esp_err_t transfer_result = esp_lcd_panel_draw_bitmap(g_dma_manager->panel_handle, transfer->x_start, current_y, transfer->x_end, chunk_y_end, dma_data);
+        const esp_err_t transfer_result = esp_lcd_panel_draw_bitmap(m->panel_handle, transfer->x_start, current_y, transfer->x_end, chunk_y_end, dma_data);
         if (transfer_result != ESP_OK)
         {
             log_e("LCD panel transfer failed: %s", esp_err_to_name(transfer_result));
+            // No completion will be reported
+            if (m->staging_free != NULL)
+                xSemaphoreGive(m->staging_free);
+
             return transfer_result;
         }
 
@@ -230,8 +483,16 @@ static esp_err_t smartdisplay_dma_transfer_chunk(const smartdisplay_dma_transfer
         remaining -= chunk_size;
         current_y = chunk_y_end;
 
-        // Small delay to prevent overwhelming the system
-        vTaskDelay(1);
+        // Small delay to prevent overwhelming the system, the staging buffer may still be being sent
+        if (m->staging_free == NULL)
+            vTaskDelay(1);
+    }
+
+    // The source may be reused once the callback is called
+    if (m->staging_free != NULL && smartdisplay_dma_wait_staging_free(m) != ESP_OK)
+    {
+        log_e("Transfer not completed in time");
+        return ESP_ERR_TIMEOUT;
     }
 
     return ESP_OK;
@@ -240,37 +501,48 @@ static esp_err_t smartdisplay_dma_transfer_chunk(const smartdisplay_dma_transfer
 // DMA worker task implementation
 static void smartdisplay_dma_worker_task(void *pvParameters)
 {
+    smartdisplay_dma_manager_t *m = pvParameters;
     log_i("DMA worker task started");
 
     smartdisplay_dma_transfer_t transfer;
+#ifdef SMARTDISPLAY_DMA_BENCHMARK
+    int64_t benchmark_start_us = esp_timer_get_time();
+    uint64_t benchmark_bytes = 0, benchmark_busy_us = 0;
+#endif
 
     while (1)
     {
         // Wait for transfer request
-        if (xQueueReceive(g_dma_manager->transfer_queue, &transfer, portMAX_DELAY) == pdTRUE)
+        if (xQueueReceive(m->transfer_queue, &transfer, portMAX_DELAY) == pdTRUE)
         {
             // Update state
-            if (xSemaphoreTake(g_dma_manager->state_mutex, portMAX_DELAY) == pdTRUE)
+            if (xSemaphoreTake(m->state_mutex, portMAX_DELAY) == pdTRUE)
             {
-                g_dma_manager->state = SMARTDISPLAY_DMA_STATE_BUSY;
-                xSemaphoreGive(g_dma_manager->state_mutex);
+                m->state = SMARTDISPLAY_DMA_STATE_BUSY;
+                xSemaphoreGive(m->state_mutex);
             }
 
             // Perform transfer
-            const esp_err_t result = smartdisplay_dma_transfer_chunk(&transfer);
+            const int64_t start_us = esp_timer_get_time();
+            const esp_err_t result = smartdisplay_dma_transfer_chunk(m, &transfer);
             const bool success = result == ESP_OK;
+            const int64_t end_us = esp_timer_get_time();
 
             // Update statistics
-            if (xSemaphoreTake(g_dma_manager->state_mutex, portMAX_DELAY) == pdTRUE)
+            if (xSemaphoreTake(m->state_mutex, portMAX_DELAY) == pdTRUE)
             {
-                g_dma_manager->active_transfers--;
+                m->active_transfers--;
                 if (success)
-                    g_dma_manager->completed_transfers++;
+                {
+                    m->completed_transfers++;
+                    m->bytes_transferred += transfer.data_len;
+                    m->busy_us += end_us - start_us;
+                }
                 else
-                    g_dma_manager->failed_transfers++;
+                    m->failed_transfers++;
 
-                g_dma_manager->state = SMARTDISPLAY_DMA_STATE_IDLE;
-                xSemaphoreGive(g_dma_manager->state_mutex);
+                m->state = SMARTDISPLAY_DMA_STATE_IDLE;
+                xSemaphoreGive(m->state_mutex);
             }
 
             // Call completion callback
@@ -278,136 +550,268 @@ static void smartdisplay_dma_worker_task(void *pvParameters)
                 transfer.callback(success, transfer.user_data);
 
             log_d("Transfer completed: %s (%d bytes)", success ? "SUCCESS" : "FAILED", transfer.data_len);
+
+#ifdef SMARTDISPLAY_DMA_BENCHMARK
+            if (end_us - benchmark_start_us >= SMARTDISPLAY_DMA_BENCHMARK_INTERVAL_MS * 1000LL)
+            {
+                const uint64_t bytes = m->bytes_transferred - benchmark_bytes;
+                const uint64_t busy_us = m->busy_us - benchmark_busy_us;
+                // Bytes per microsecond is MB/s
+                log_i("DMA throughput: %.2f MB/s while busy, %.2f MB/s overall, %d%% busy", busy_us ? (float)bytes / busy_us : 0.0f, (float)bytes / (end_us - benchmark_start_us), (int)(busy_us * 100 / (end_us - benchmark_start_us)));
+                benchmark_start_us = end_us;
+                benchmark_bytes = m->bytes_transferred;
+                benchmark_busy_us = m->busy_us;
+            }
+#endif
         }
     }
 }
 
-esp_err_t smartdisplay_dma_init(esp_lcd_panel_handle_t panel_handle)
+// Free a manager and its resources, the worker task must not be running
+static void smartdisplay_dma_free(smartdisplay_dma_manager_t *m)
+{
+    // Delete queue
+    if (m->transfer_queue != NULL)
+        vQueueDelete(m->transfer_queue);
+
+    // Delete mutex
+    if (m->state_mutex != NULL)
+        vSemaphoreDelete(m->state_mutex);
+
+    // Free the staging buffers, the first is the DMA buffer
+    if (m->staging_free != NULL)
+        vSemaphoreDelete(m->staging_free);
+
+    for (int i = 1; i < SMARTDISPLAY_DMA_INFLIGHT_TRANSFERS; i++)
+        if (m->staging_buffers[i] != NULL)
+            heap_caps_free(m->staging_buffers[i]);
+
+    // Free DMA buffer
+    if (m->dma_buffer != NULL)
+        heap_caps_free(m->dma_buffer);
+
+    free(m);
+}
+
+esp_err_t smartdisplay_dma_init(esp_lcd_panel_handle_t panel_handle, bool te_sync)
 {
-    if (g_dma_manager != NULL)
+    if (panel_handle == NULL)
+    {
+        log_e("Invalid panel handle");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (smartdisplay_dma_get(panel_handle) != NULL)
     {
         log_w("DMA manager already initialized");
         return ESP_OK;
     }
 
-    if (panel_handle == NULL)
+    int slot;
+    for (slot = 0; slot < SMARTDISPLAY_DMA_MAX_PANELS && g_dma_managers[slot] != NULL; slot++)
+        ;
+    if (slot == SMARTDISPLAY_DMA_MAX_PANELS)
     {
-        log_e("Invalid panel handle");
-        return ESP_ERR_INVALID_ARG;
+        log_e("No DMA manager left, increase SMARTDISPLAY_DMA_MAX_PANELS");
+        return ESP_ERR_NO_MEM;
     }
 
     // Allocate DMA manager
-    g_dma_manager = heap_caps_calloc(1, sizeof(smartdisplay_dma_manager_t), MALLOC_CAP_DEFAULT);
-    if (g_dma_manager == NULL)
+    smartdisplay_dma_manager_t *m = heap_caps_calloc(1, sizeof(smartdisplay_dma_manager_t), MALLOC_CAP_DEFAULT);
+    if (m == NULL)
     {
         log_e("Failed to allocate DMA manager");
         return ESP_ERR_NO_MEM;
     }
 
     // Allocate DMA-capable buffer
-    g_dma_manager->dma_buffer = heap_caps_malloc(SMARTDISPLAY_DMA_BUFFER_SIZE, MALLOC_CAP_DMA | MALLOC_CAP_32BIT);
-    if (g_dma_manager->dma_buffer == NULL)
+    m->dma_buffer = heap_caps_malloc(SMARTDISPLAY_DMA_BUFFER_SIZE, MALLOC_CAP_DMA | MALLOC_CAP_32BIT);
+    if (m->dma_buffer == NULL)
     {
         log_e("Failed to allocate DMA buffer");
-        free(g_dma_manager);
-        g_dma_manager = NULL;
+        smartdisplay_dma_free(m);
         return ESP_ERR_NO_MEM;
     }
 
-    g_dma_manager->dma_buffer_size = SMARTDISPLAY_DMA_BUFFER_SIZE;
+    m->dma_buffer_size = SMARTDISPLAY_DMA_BUFFER_SIZE;
 
     // Create transfer queue
-    g_dma_manager->transfer_queue = xQueueCreate(SMARTDISPLAY_DMA_QUEUE_SIZE, sizeof(smartdisplay_dma_transfer_t));
-    if (g_dma_manager->transfer_queue == NULL)
+    m->transfer_queue = xQueueCreate(SMARTDISPLAY_DMA_QUEUE_SIZE, sizeof(smartdisplay_dma_transfer_t));
+    if (m->transfer_queue == NULL)
     {
         log_e("Failed to create transfer queue");
-        smartdisplay_dma_deinit();
+        smartdisplay_dma_free(m);
         return ESP_ERR_NO_MEM;
     }
 
     // Create state mutex
-    g_dma_manager->state_mutex = xSemaphoreCreateMutex();
-    if (g_dma_manager->state_mutex == NULL)
+    m->state_mutex = xSemaphoreCreateMutex();
+    if (m->state_mutex == NULL)
     {
         log_e("Failed to create state mutex");
-        smartdisplay_dma_deinit();
+        smartdisplay_dma_free(m);
         return ESP_ERR_NO_MEM;
     }
 
     // Initialize state
-    *g_dma_manager = (smartdisplay_dma_manager_t){
+    *m = (smartdisplay_dma_manager_t){
         .panel_handle = panel_handle,
         .state = SMARTDISPLAY_DMA_STATE_IDLE,
         .active_transfers = 0,
         .completed_transfers = 0,
         .failed_transfers = 0,
-        .transfer_queue = g_dma_manager->transfer_queue,
-        .state_mutex = g_dma_manager->state_mutex,
-        .dma_buffer = g_dma_manager->dma_buffer,
-        .dma_buffer_size = g_dma_manager->dma_buffer_size};
+        .transfer_queue = m->transfer_queue,
+        .state_mutex = m->state_mutex,
+        .dma_buffer = m->dma_buffer,
+        .dma_buffer_size = m->dma_buffer_size,
+        .bits_per_pixel = 16,
+        .staging_buffers = {m->dma_buffer},
+        .te_sync = te_sync};
 
     // Create worker task
     const BaseType_t task_result = xTaskCreatePinnedToCore(
         smartdisplay_dma_worker_task,
         "dma_worker",
         4096, // Stack size
-        NULL,
+        m,
         5, // Priority (higher than LVGL)
-        &g_dma_manager->worker_task,
+        &m->worker_task,
         1 // Pin to core 1
     );
 
     if (task_result != pdPASS)
     {
         log_e("Failed to create DMA worker task");
-        smartdisplay_dma_deinit();
+        smartdisplay_dma_free(m);
         return ESP_ERR_NO_MEM;
     }
 
+    // Published once complete, the other functions find it from now on
+    g_dma_managers[slot] = m;
     log_i("DMA manager initialized with %d KB buffer", SMARTDISPLAY_DMA_BUFFER_SIZE / 1024);
     return ESP_OK;
 }
 
-esp_err_t smartdisplay_dma_deinit()
+esp_err_t smartdisplay_dma_track_trans_done(esp_lcd_panel_handle_t panel_handle)
 {
-    if (g_dma_manager == NULL)
+    smartdisplay_dma_manager_t *m = smartdisplay_dma_get(panel_handle);
+    if (m == NULL)
+        return ESP_ERR_INVALID_STATE;
+
+    if (m->staging_free != NULL)
         return ESP_OK;
 
-    // Wait for all transfers to complete
-    smartdisplay_dma_wait_all_done(SMARTDISPLAY_DMA_TIMEOUT_MS);
+    // Wait for the transfers sent from the single buffer
+    smartdisplay_dma_wait_idle(m, SMARTDISPLAY_DMA_TIMEOUT_MS);
 
-    // Delete worker task
-    if (g_dma_manager->worker_task != NULL)
+    for (int i = 1; i < SMARTDISPLAY_DMA_INFLIGHT_TRANSFERS; i++)
     {
-        vTaskDelete(g_dma_manager->worker_task);
-        g_dma_manager->worker_task = NULL;
+        m->staging_buffers[i] = heap_caps_malloc(m->dma_buffer_size, MALLOC_CAP_DMA | MALLOC_CAP_32BIT);
+        if (m->staging_buffers[i] == NULL)
+        {
+            log_e("Failed to allocate staging buffer");
+            for (int j = 1; j < i; j++)
+            {
+                heap_caps_free(m->staging_buffers[j]);
+                m->staging_buffers[j] = NULL;
+            }
+
+            return ESP_ERR_NO_MEM;
+        }
     }
 
-    // Delete queue
-    if (g_dma_manager->transfer_queue != NULL)
+    m->next_staging_buffer = 0;
+    // Set last, the worker uses the staging buffers once it is not NULL
+    m->staging_free = xSemaphoreCreateCounting(SMARTDISPLAY_DMA_INFLIGHT_TRANSFERS, SMARTDISPLAY_DMA_INFLIGHT_TRANSFERS);
+    if (m->staging_free == NULL)
     {
-        vQueueDelete(g_dma_manager->transfer_queue);
-        g_dma_manager->transfer_queue = NULL;
+        log_e("Failed to create staging semaphore");
+        for (int i = 1; i < SMARTDISPLAY_DMA_INFLIGHT_TRANSFERS; i++)
+        {
+            heap_caps_free(m->staging_buffers[i]);
+            m->staging_buffers[i] = NULL;
+        }
+
+        return ESP_ERR_NO_MEM;
     }
 
-    // Delete mutex
-    if (g_dma_manager->state_mutex != NULL)
+    log_i("DMA transfers tracked, %d staging buffers", SMARTDISPLAY_DMA_INFLIGHT_TRANSFERS);
+    return ESP_OK;
+}
+
+bool IRAM_ATTR smartdisplay_dma_trans_done_from_isr(esp_lcd_panel_handle_t panel_handle)
+{
+    // Not smartdisplay_dma_get(), it is not in IRAM
+    for (int i = 0; i < SMARTDISPLAY_DMA_MAX_PANELS; i++)
     {
-        vSemaphoreDelete(g_dma_manager->state_mutex);
-        g_dma_manager->state_mutex = NULL;
+        smartdisplay_dma_manager_t *m = g_dma_managers[i];
+        if (m != NULL && m->panel_handle == panel_handle && m->staging_free != NULL)
+        {
+            BaseType_t need_yield = pdFALSE;
+            xSemaphoreGiveFromISR(m->staging_free, &need_yield);
+            return need_yield == pdTRUE;
+        }
     }
 
-    // Free DMA buffer
-    if (g_dma_manager->dma_buffer != NULL)
+    return false;
+}
+
+esp_err_t smartdisplay_dma_get_throughput(esp_lcd_panel_handle_t panel_handle, uint64_t *bytes_transferred, uint64_t *busy_us)
+{
+    smartdisplay_dma_manager_t *m = smartdisplay_dma_get(panel_handle);
+    if (m == NULL)
+        return ESP_ERR_INVALID_STATE;
+
+    if (xSemaphoreTake(m->state_mutex, pdMS_TO_TICKS(100)) != pdTRUE)
+        return ESP_ERR_TIMEOUT;
+
+    if (bytes_transferred)
+        *bytes_transferred = m->bytes_transferred;
+
+    if (busy_us)
+        *busy_us = m->busy_us;
+
+    xSemaphoreGive(m->state_mutex);
+    return ESP_OK;
+}
+
+esp_err_t smartdisplay_dma_set_bits_per_pixel(esp_lcd_panel_handle_t panel_handle, uint8_t bits_per_pixel)
+{
+    smartdisplay_dma_manager_t *m = smartdisplay_dma_get(panel_handle);
+    if (m == NULL)
+        return ESP_ERR_INVALID_STATE;
+
+    if (bits_per_pixel != 12 && bits_per_pixel != 16)
     {
-        heap_caps_free(g_dma_manager->dma_buffer);
-        g_dma_manager->dma_buffer = NULL;
+        log_e("Invalid bits per pixel: %d. Only 12 (RGB444) and 16 (RGB565) are supported", bits_per_pixel);
+        return ESP_ERR_INVALID_ARG;
     }
 
-    // Free manager
-    free(g_dma_manager);
-    g_dma_manager = NULL;
+    // Wait for the transfers queued in the previous format
+    smartdisplay_dma_wait_idle(m, SMARTDISPLAY_DMA_TIMEOUT_MS);
+    m->bits_per_pixel = bits_per_pixel;
+    return ESP_OK;
+}
+
+esp_err_t smartdisplay_dma_deinit(esp_lcd_panel_handle_t panel_handle)
+{
+    smartdisplay_dma_manager_t *m = smartdisplay_dma_get(panel_handle);
+    if (m == NULL)
+        return ESP_OK;
 
+    // Wait for all transfers to complete
+    smartdisplay_dma_wait_idle(m, SMARTDISPLAY_DMA_TIMEOUT_MS);
+
+    // Unpublish before freeing
+    for (int i = 0; i < SMARTDISPLAY_DMA_MAX_PANELS; i++)
+        if (g_dma_managers[i] == m)
+            g_dma_managers[i] = NULL;
+
+    // Delete worker task
+    if (m->worker_task != NULL)
+        vTaskDelete(m->worker_task);
+
+    smartdisplay_dma_free(m);
     log_i("DMA manager deinitialized");
     return ESP_OK;
-}
\ No newline at end of file
+}
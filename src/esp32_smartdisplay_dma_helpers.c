@@ -1,48 +1,640 @@
 #include <esp32_smartdisplay_dma_helpers.h>
 #include <esp32_smartdisplay.h>
+#include <esp_heap_caps.h>
+#include <string.h>
+#include <math.h>
 
 // Minimum transfer size to justify DMA overhead (configurable)
 #ifndef SMARTDISPLAY_DMA_MIN_TRANSFER_SIZE
 #define SMARTDISPLAY_DMA_MIN_TRANSFER_SIZE 1024 // 1KB minimum
 #endif
 
+#ifdef SMARTDISPLAY_RGB444
+#if !defined(DISPLAY_ST7789_SPI) && !defined(DISPLAY_ST7796_SPI)
+#error "SMARTDISPLAY_RGB444 is only supported by the ST7789 and ST7796 SPI panels"
+#endif
+#ifdef SMARTDISPLAY_SHADOW_FRAMEBUFFER
+#error "SMARTDISPLAY_RGB444 can not be combined with SMARTDISPLAY_SHADOW_FRAMEBUFFER"
+#endif
+#if DISPLAY_ROUND
+#error "SMARTDISPLAY_RGB444 can not be combined with DISPLAY_ROUND"
+#endif
+
+#ifdef SMARTDISPLAY_RGB444_DITHER
+// 4x4 Bayer matrix, thresholds 0-15
+static const uint8_t smartdisplay_bayer_4x4[4][4] = {
+    {0, 8, 2, 10},
+    {12, 4, 14, 6},
+    {3, 11, 1, 9},
+    {15, 7, 13, 5}};
+#endif
+
+// Convert a RGB565 pixel to RGB444 (0x0RGB)
+static inline uint16_t smartdisplay_rgb565_to_rgb444(uint16_t color, int32_t x, int32_t y)
+{
+#ifdef SMARTDISPLAY_RGB444_DITHER
+    // Ordered dithering, the threshold is scaled to the number of bits dropped
+    const uint8_t threshold = smartdisplay_bayer_4x4[y & 0x3][x & 0x3];
+    const uint8_t r = LV_MIN(((color >> 11) + (threshold >> 3)) >> 1, 0xF);
+    const uint8_t g = LV_MIN((((color >> 5) & 0x3F) + (threshold >> 2)) >> 2, 0xF);
+    const uint8_t b = LV_MIN(((color & 0x1F) + (threshold >> 3)) >> 1, 0xF);
+    return (r << 8) | (g << 4) | b;
+#else
+    return ((color >> 12) << 8) | (((color >> 7) & 0xF) << 4) | ((color >> 1) & 0xF);
+#endif
+}
+
+// Pack the RGB565 pixels in place to RGB444, two pixels in three bytes. Returns the number of bytes
+static size_t smartdisplay_rgb444_pack(const lv_area_t *area, uint8_t *px_map)
+{
+    // Three bytes are written for every four bytes read so the output never overtakes the input
+    const uint16_t *src = (const uint16_t *)px_map;
+    uint8_t *dest = px_map;
+    const uint32_t pixels = lv_area_get_size(area);
+    int32_t x = area->x1, y = area->y1;
+    for (uint32_t i = 0; i < pixels; i += 2)
+    {
+        const uint16_t p0 = smartdisplay_rgb565_to_rgb444(src[i], x, y);
+        if (++x > area->x2)
+        {
+            x = area->x1;
+            y++;
+        }
+
+        if (i + 1 == pixels)
+        {
+            // Odd number of pixels, the last byte holds only half a pixel
+            *dest++ = p0 >> 4;
+            *dest++ = p0 << 4;
+            break;
+        }
+
+        const uint16_t p1 = smartdisplay_rgb565_to_rgb444(src[i + 1], x, y);
+        if (++x > area->x2)
+        {
+            x = area->x1;
+            y++;
+        }
+
+        *dest++ = p0 >> 4;
+        *dest++ = (p0 << 4) | (p1 >> 8);
+        *dest++ = p1;
+    }
+
+    return (pixels * 12 + 7) / 8;
+}
+#endif
+
+// Draw without the DMA worker, only when the completion of the panel is not tracked
+static void smartdisplay_dma_draw_direct(esp_lcd_panel_handle_t panel_handle, int x_start, int y_start, int x_end, int y_end, const void *color_data)
+{
+    if (smartdisplay_dma_is_tracked(panel_handle))
+    {
+        log_e("DMA transfer failed, area not drawn");
+        return;
+    }
+
+    ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(panel_handle, x_start, y_start, x_end, y_end, color_data));
+}
+
+#if defined(SMARTDISPLAY_SHADOW_FRAMEBUFFER) || DISPLAY_ROUND
+// Maximum number of windows a band is split into, above that the last window covers the remaining rows
+#ifndef SMARTDISPLAY_MAX_WINDOWS
+#ifdef SMARTDISPLAY_SHADOW_MAX_WINDOWS
+#define SMARTDISPLAY_MAX_WINDOWS SMARTDISPLAY_SHADOW_MAX_WINDOWS
+#else
+#define SMARTDISPLAY_MAX_WINDOWS 8
+#endif
+#endif
+// Cost of an extra window (CASET, RASET and RAMWR commands) expressed in pixel data bytes
+#ifndef SMARTDISPLAY_WINDOW_OVERHEAD_BYTES
+#define SMARTDISPLAY_WINDOW_OVERHEAD_BYTES 32
+#endif
+
+// Pixels of a row to send, x1 > x2 if none
+typedef struct
+{
+    int32_t x1;
+    int32_t x2;
+} smartdisplay_row_span_t;
+
+#if DISPLAY_ROUND
+static smartdisplay_row_span_t smartdisplay_spans[LV_MAX(DISPLAY_WIDTH, DISPLAY_HEIGHT)];
+#endif
+#endif
+
+#ifdef SMARTDISPLAY_SHADOW_FRAMEBUFFER
+// Copy of the content of a panel, in LVGL pixel order (not swapped), kept as the driver data of the display
+typedef struct
+{
+    uint16_t *pixels;               // NULL if it could not be allocated
+    smartdisplay_row_span_t *spans; // Changed span of every row of the band
+    uint32_t *primed_rows;          // Rows completely written since the shadow was invalidated, one bit per row
+    int32_t primed_count;
+    int32_t hor_res;
+    int32_t ver_res;
+    bool valid;
+} smartdisplay_shadow_t;
+
+// Index of the first different pixel, count if the rows are equal
+static int32_t smartdisplay_shadow_first_diff(const uint16_t *a, const uint16_t *b, int32_t count)
+{
+    int32_t i = 0;
+    // Compare two pixels at once if both rows have the same word alignment
+    if ((((uintptr_t)a ^ (uintptr_t)b) & 3) == 0)
+    {
+        if (((uintptr_t)a & 3) != 0 && count > 0)
+        {
+            if (a[0] != b[0])
+                return 0;
+
+            i = 1;
+        }
+
+        const uint32_t *wa = (const uint32_t *)(a + i);
+        const uint32_t *wb = (const uint32_t *)(b + i);
+        const int32_t words = (count - i) / 2;
+        int32_t w = 0;
+        while (w < words && wa[w] == wb[w])
+            w++;
+
+        i += w * 2;
+    }
+
+    while (i < count && a[i] == b[i])
+        i++;
+
+    return i;
+}
+
+// Index of the last different pixel, -1 if the rows are equal
+static int32_t smartdisplay_shadow_last_diff(const uint16_t *a, const uint16_t *b, int32_t count)
+{
+    int32_t i = count - 1;
+    // Compare two pixels at once if both rows have the same word alignment
+    if ((((uintptr_t)a ^ (uintptr_t)b) & 3) == 0)
+    {
+        if (((uintptr_t)(a + count) & 3) != 0 && i >= 0)
+        {
+            if (a[i] != b[i])
+                return i;
+
+            i--;
+        }
+
+        // Words ending at pixel i
+        while (i >= 1 && *(const uint32_t *)(a + i - 1) == *(const uint32_t *)(b + i - 1))
+            i -= 2;
+    }
+
+    while (i >= 0 && a[i] == b[i])
+        i--;
+
+    return i;
+}
+
+static void smartdisplay_shadow_reset(smartdisplay_shadow_t *shadow, lv_display_t *display)
+{
+    shadow->hor_res = lv_display_get_horizontal_resolution(display);
+    shadow->ver_res = lv_display_get_vertical_resolution(display);
+    shadow->primed_count = 0;
+    shadow->valid = false;
+    memset(shadow->primed_rows, 0, (LV_MAX(shadow->hor_res, shadow->ver_res) + 31) / 32 * sizeof(uint32_t));
+}
+
+void smartdisplay_shadow_invalidate(lv_display_t *display)
+{
+    smartdisplay_shadow_t *shadow = lv_display_get_driver_data(display);
+    if (shadow == NULL || shadow->pixels == NULL)
+        return;
+
+    // All pixels are sent until the shadow has been completely written again
+    smartdisplay_shadow_reset(shadow, display);
+    lv_obj_invalidate(lv_display_get_screen_active(display));
+}
+
+// A rotation changes the mapping to the frame memory, even when the resolution is the same (0 and 180 degrees)
+static void smartdisplay_shadow_resolution_changed(lv_event_t *event)
+{
+    smartdisplay_shadow_invalidate(lv_event_get_target(event));
+}
+
+// Shadow of the display, allocated at the first flush. NULL if it could not be allocated
+static smartdisplay_shadow_t *smartdisplay_shadow_of(lv_display_t *display)
+{
+    smartdisplay_shadow_t *shadow = lv_display_get_driver_data(display);
+    if (shadow != NULL)
+        return shadow->pixels != NULL ? shadow : NULL;
+
+    if ((shadow = heap_caps_calloc(1, sizeof(smartdisplay_shadow_t), MALLOC_CAP_DEFAULT)) == NULL)
+        return NULL;
+
+    lv_display_set_driver_data(display, shadow);
+    const int32_t hor_res = lv_display_get_horizontal_resolution(display);
+    const int32_t ver_res = lv_display_get_vertical_resolution(display);
+    const int32_t lines = LV_MAX(hor_res, ver_res);
+    shadow->pixels = heap_caps_malloc(hor_res * ver_res * sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+    shadow->spans = heap_caps_malloc(lines * sizeof(smartdisplay_row_span_t), MALLOC_CAP_DEFAULT);
+    shadow->primed_rows = heap_caps_malloc((lines + 31) / 32 * sizeof(uint32_t), MALLOC_CAP_DEFAULT);
+    if (shadow->pixels == NULL || shadow->spans == NULL || shadow->primed_rows == NULL)
+    {
+        log_w("Unable to allocate shadow framebuffer, sending complete areas");
+        heap_caps_free(shadow->pixels);
+        heap_caps_free(shadow->spans);
+        heap_caps_free(shadow->primed_rows);
+        *shadow = (smartdisplay_shadow_t){0};
+        return NULL;
+    }
+
+    log_i("Shadow framebuffer allocated (%d bytes)", hor_res * ver_res * sizeof(uint16_t));
+    smartdisplay_shadow_reset(shadow, display);
+    lv_display_add_event_cb(display, smartdisplay_shadow_resolution_changed, LV_EVENT_RESOLUTION_CHANGED, NULL);
+    return shadow;
+}
+
+// Compare the band against the shadow framebuffer, update it and return the changed span of every row in shadow->spans
+static void smartdisplay_shadow_diff(smartdisplay_shadow_t *shadow, const lv_area_t *area, const uint16_t *px_map)
+{
+    const int32_t w = lv_area_get_width(area);
+    const int32_t h = lv_area_get_height(area);
+    // Until the shadow is valid, only rows written over their full width are known
+    const bool full_rows = area->x1 == 0 && w == shadow->hor_res;
+    for (int32_t row = 0; row < h; row++)
+    {
+        const int32_t y = area->y1 + row;
+        const uint16_t *src = px_map + row * w;
+        uint16_t *dest = shadow->pixels + y * shadow->hor_res + area->x1;
+        int32_t first = 0, last = w - 1;
+        if (shadow->valid)
+        {
+            first = smartdisplay_shadow_first_diff(src, dest, w);
+            last = first < w ? smartdisplay_shadow_last_diff(src, dest, w) : -1;
+        }
+        else if (full_rows && !(shadow->primed_rows[y / 32] & (1u << (y % 32))))
+        {
+            shadow->primed_rows[y / 32] |= 1u << (y % 32);
+            shadow->primed_count++;
+        }
+
+        shadow->spans[row] = (smartdisplay_row_span_t){.x1 = first, .x2 = last};
+        if (first <= last)
+            memcpy(dest + first, src + first, (last - first + 1) * sizeof(uint16_t));
+    }
+
+    if (!shadow->valid && shadow->primed_count == shadow->ver_res)
+        shadow->valid = true;
+}
+
+// Reverse the order of the rows [first, last] of the shadow, row is a buffer of a row
+static void smartdisplay_shadow_reverse_rows(smartdisplay_shadow_t *shadow, int32_t first, int32_t last, uint16_t *row)
+{
+    const size_t row_size = shadow->hor_res * sizeof(uint16_t);
+    for (; first < last; first++, last--)
+    {
+        uint16_t *a = shadow->pixels + first * shadow->hor_res;
+        uint16_t *b = shadow->pixels + last * shadow->hor_res;
+        memcpy(row, a, row_size);
+        memcpy(a, b, row_size);
+        memcpy(b, row, row_size);
+    }
+}
+
+void smartdisplay_shadow_scroll(lv_display_t *display, int32_t y, int32_t height, int32_t dy)
+{
+    smartdisplay_shadow_t *shadow = lv_display_get_driver_data(display);
+    if (shadow == NULL || shadow->pixels == NULL || height <= 0 || y < 0 || y + height > shadow->ver_res || dy % height == 0)
+        return;
+
+    // While priming, start again: the rows written completely move in the area
+    if (!shadow->valid)
+    {
+        smartdisplay_shadow_reset(shadow, display);
+        return;
+    }
+
+    uint16_t *row = heap_caps_malloc(shadow->hor_res * sizeof(uint16_t), MALLOC_CAP_DEFAULT);
+    if (row == NULL)
+    {
+        log_w("Unable to scroll the shadow framebuffer, invalidating it");
+        smartdisplay_shadow_invalidate(display);
+        return;
+    }
+
+    // Like the frame memory, the rows scrolled out at the top wrap around to the bottom: rotate the area up by dy rows
+    const int32_t shift = (dy % height + height) % height;
+    const int32_t last = y + height - 1;
+    smartdisplay_shadow_reverse_rows(shadow, y, y + shift - 1, row);
+    smartdisplay_shadow_reverse_rows(shadow, y + shift, last, row);
+    smartdisplay_shadow_reverse_rows(shadow, y, last, row);
+    heap_caps_free(row);
+}
+
+const uint16_t *smartdisplay_shadow_get(lv_display_t *display, int32_t *hor_res, int32_t *ver_res)
+{
+    const smartdisplay_shadow_t *shadow = display != NULL ? lv_display_get_driver_data(display) : NULL;
+    if (hor_res == NULL || ver_res == NULL || shadow == NULL || !shadow->valid)
+        return NULL;
+
+    *hor_res = shadow->hor_res;
+    *ver_res = shadow->ver_res;
+    return shadow->pixels;
+}
+#endif
+
+#if DISPLAY_ROUND
+// Visible pixels of every row (absolute) of a round display, only the circle inscribed in the frame memory is visible
+static struct
+{
+    int32_t hor_res;
+    int32_t ver_res;
+    smartdisplay_row_span_t rows[LV_MAX(DISPLAY_WIDTH, DISPLAY_HEIGHT)];
+} round_mask;
+
+// Clip the spans (relative to the area) to the visible circle
+static void smartdisplay_round_clip(lv_display_t *display, const lv_area_t *area, smartdisplay_row_span_t *spans)
+{
+    const int32_t hor_res = lv_display_get_horizontal_resolution(display);
+    const int32_t ver_res = lv_display_get_vertical_resolution(display);
+    if (round_mask.hor_res != hor_res || round_mask.ver_res != ver_res)
+    {
+        // A pixel is visible if the circle covers any part of it
+        const float cx = hor_res / 2.0f;
+        const float cy = ver_res / 2.0f;
+        const float r = LV_MIN(hor_res, ver_res) / 2.0f;
+        for (int32_t y = 0; y < ver_res; y++)
+        {
+            // Vertical distance from the center to the closest edge of the row
+            const float dy = y + 1 <= cy ? cy - (y + 1) : (y >= cy ? y - cy : 0.0f);
+            if (dy >= r)
+            {
+                round_mask.rows[y] = (smartdisplay_row_span_t){.x1 = 0, .x2 = -1};
+                continue;
+            }
+
+            const float half = sqrtf(r * r - dy * dy);
+            round_mask.rows[y] = (smartdisplay_row_span_t){.x1 = LV_MAX((int32_t)floorf(cx - half), 0), .x2 = LV_MIN((int32_t)ceilf(cx + half) - 1, hor_res - 1)};
+        }
+
+        round_mask.hor_res = hor_res;
+        round_mask.ver_res = ver_res;
+    }
+
+    const int32_t h = lv_area_get_height(area);
+    for (int32_t row = 0; row < h; row++)
+    {
+        const smartdisplay_row_span_t *visible = &round_mask.rows[area->y1 + row];
+        spans[row].x1 = LV_MAX(spans[row].x1, visible->x1 - area->x1);
+        spans[row].x2 = LV_MIN(spans[row].x2, visible->x2 - area->x1);
+    }
+}
+#endif
+
+#if defined(SMARTDISPLAY_SHADOW_FRAMEBUFFER) || DISPLAY_ROUND
+// Merge the row spans into windows (absolute coordinates), returns the number of windows
+static size_t smartdisplay_spans_to_windows(const lv_area_t *area, const smartdisplay_row_span_t *spans, lv_area_t *windows, size_t max_windows)
+{
+    size_t count = 0;
+    lv_area_t *window = NULL;
+    const int32_t h = lv_area_get_height(area);
+    for (int32_t row = 0; row < h; row++)
+    {
+        const smartdisplay_row_span_t *span = &spans[row];
+        if (span->x1 > span->x2)
+        {
+            // Unchanged row ends the window
+            window = NULL;
+            continue;
+        }
+
+        const int32_t x1 = area->x1 + span->x1;
+        const int32_t x2 = area->x1 + span->x2;
+        if (window != NULL)
+        {
+            // Extend the window if sending the extra pixels is cheaper than a new window
+            const int32_t merged_x1 = LV_MIN(window->x1, x1);
+            const int32_t merged_x2 = LV_MAX(window->x2, x2);
+            const int32_t window_h = lv_area_get_height(window);
+            const int32_t extra_bytes = ((merged_x2 - merged_x1 + 1) * (window_h + 1) - lv_area_get_width(window) * window_h - (x2 - x1 + 1)) * sizeof(uint16_t);
+            if (extra_bytes <= SMARTDISPLAY_WINDOW_OVERHEAD_BYTES)
+            {
+                *window = (lv_area_t){.x1 = merged_x1, .y1 = window->y1, .x2 = merged_x2, .y2 = area->y1 + row};
+                continue;
+            }
+        }
+
+        if (count == max_windows)
+        {
+            // Too many windows, the last one grows to cover the remaining rows
+            window = &windows[count - 1];
+            lv_area_join(window, window, &(lv_area_t){.x1 = x1, .y1 = area->y1 + row, .x2 = x2, .y2 = area->y1 + row});
+            continue;
+        }
+
+        window = &windows[count++];
+        *window = (lv_area_t){.x1 = x1, .y1 = area->y1 + row, .x2 = x2, .y2 = area->y1 + row};
+    }
+
+    return count;
+}
+
+// Pack the windows to the start of px_map, swapping the bytes if requested, and transfer them
+static void smartdisplay_dma_flush_windows(lv_display_t *display, const lv_area_t *area, uint8_t *px_map, esp_lcd_panel_handle_t panel_handle, const lv_area_t *windows, size_t count, bool swap)
+{
+    // Windows are ordered top to bottom so the data only moves towards the start of the buffer
+    const int32_t w = lv_area_get_width(area);
+    const uint16_t *data[SMARTDISPLAY_MAX_WINDOWS];
+    uint16_t *dest = (uint16_t *)px_map;
+    size_t total_pixels = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const lv_area_t *window = &windows[i];
+        const int32_t window_w = lv_area_get_width(window);
+        data[i] = dest;
+        for (int32_t y = window->y1; y <= window->y2; y++)
+        {
+            const uint16_t *src = (const uint16_t *)px_map + (y - area->y1) * w + (window->x1 - area->x1);
+            if (swap)
+                for (int32_t x = 0; x < window_w; x++)
+                    dest[x] = (src[x] >> 8) | (src[x] << 8);
+            else
+                memmove(dest, src, window_w * sizeof(uint16_t));
+
+            dest += window_w;
+        }
+
+        total_pixels += lv_area_get_size(window);
+    }
+
+    log_v("Sending %d of %d pixels in %d windows", total_pixels, lv_area_get_size(area), count);
+
+    size_t sent = 0;
+    if (smartdisplay_dma_should_use_for_size(panel_handle, total_pixels * sizeof(uint16_t)))
+    {
+        // The completion of the last window completes the flush
+        for (; sent < count; sent++)
+        {
+            const bool last = sent == count - 1;
+            const lv_area_t *window = &windows[sent];
+            if (smartdisplay_dma_queue_bitmap(panel_handle, window->x1, window->y1, window->x2 + 1, window->y2 + 1, data[sent], last ? smartdisplay_dma_lvgl_flush_callback : NULL, last ? display : NULL, false) != ESP_OK)
+                break;
+        }
+
+        if (sent == count)
+            return;
+
+        // Do not interleave with the queued windows
+        if (sent > 0)
+            smartdisplay_dma_wait_all_done(panel_handle, SMARTDISPLAY_DMA_TIMEOUT_MS);
+    }
+
+    for (; sent < count; sent++)
+    {
+        const lv_area_t *window = &windows[sent];
+        smartdisplay_dma_draw_direct(panel_handle, window->x1, window->y1, window->x2 + 1, window->y2 + 1, data[sent]);
+    }
+
+    lv_display_flush_ready(display);
+}
+
+// Send the spans of the band (relative to the area) merged into windows
+static void smartdisplay_dma_flush_spans(lv_display_t *display, const lv_area_t *area, uint8_t *px_map, esp_lcd_panel_handle_t panel_handle, const smartdisplay_row_span_t *spans, bool swap)
+{
+    lv_area_t windows[SMARTDISPLAY_MAX_WINDOWS];
+    const size_t count = smartdisplay_spans_to_windows(area, spans, windows, SMARTDISPLAY_MAX_WINDOWS);
+    if (count == 0)
+    {
+        // Nothing to send
+        lv_display_flush_ready(display);
+        return;
+    }
+
+    smartdisplay_dma_flush_windows(display, area, px_map, panel_handle, windows, count, swap);
+}
+#endif
+
+#ifdef SMARTDISPLAY_SHADOW_FRAMEBUFFER
+static esp_err_t smartdisplay_shadow_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map, esp_lcd_panel_handle_t panel_handle, bool round, bool swap)
+{
+    smartdisplay_shadow_t *shadow = smartdisplay_shadow_of(display);
+    if (shadow == NULL)
+        return ESP_ERR_NO_MEM;
+
+    // After a rotation not reported by an event the shadow is rebuilt as well
+    if (shadow->hor_res != lv_display_get_horizontal_resolution(display) || shadow->ver_res != lv_display_get_vertical_resolution(display))
+        smartdisplay_shadow_reset(shadow, display);
+
+    smartdisplay_shadow_diff(shadow, area, (const uint16_t *)px_map);
+#if DISPLAY_ROUND
+    if (round)
+        smartdisplay_round_clip(display, area, shadow->spans);
+#endif
+    smartdisplay_dma_flush_spans(display, area, px_map, panel_handle, shadow->spans, swap);
+    return ESP_OK;
+}
+#endif
+
+#if DISPLAY_ROUND
+// Only send the visible span of every row, the invisible pixels are not swapped either
+static void smartdisplay_round_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map, esp_lcd_panel_handle_t panel_handle, bool swap)
+{
+    const int32_t w = lv_area_get_width(area);
+    const int32_t h = lv_area_get_height(area);
+    for (int32_t row = 0; row < h; row++)
+        smartdisplay_spans[row] = (smartdisplay_row_span_t){.x1 = 0, .x2 = w - 1};
+
+    smartdisplay_round_clip(display, area, smartdisplay_spans);
+    smartdisplay_dma_flush_spans(display, area, px_map, panel_handle, smartdisplay_spans, swap);
+}
+#endif
+
+static smartdisplay_dma_frame_flushed_cb_t smartdisplay_frame_flushed_cb;
+
+void smartdisplay_dma_set_frame_flushed_cb(smartdisplay_dma_frame_flushed_cb_t cb)
+{
+    smartdisplay_frame_flushed_cb = cb;
+}
+
+// Complete a flush from the DMA worker task
+static void smartdisplay_dma_flush_ready(lv_display_t *display)
+{
+    // LVGL moves on to the next band once the flush is ready
+    const bool last = lv_display_flush_is_last(display);
+    lv_display_flush_ready(display);
+    if (last && smartdisplay_frame_flushed_cb != NULL)
+        smartdisplay_frame_flushed_cb(display);
+}
+
 void smartdisplay_dma_lvgl_flush_callback(bool success, void *user_data)
 {
     lv_display_t *display = (lv_display_t *)user_data;
     if (!success)
         log_e("DMA transfer failed for LVGL flush");
 
-    lv_display_flush_ready(display);
+    smartdisplay_dma_flush_ready(display);
 }
 
-bool smartdisplay_dma_should_use_for_size(size_t transfer_size)
+bool smartdisplay_dma_should_use_for_size(esp_lcd_panel_handle_t panel_handle, size_t transfer_size)
 {
     // Only use DMA for transfers above minimum threshold
-    // Small transfers may be faster with direct CPU copy
-    return transfer_size >= SMARTDISPLAY_DMA_MIN_TRANSFER_SIZE;
+    // Small transfers may be faster with direct CPU copy, except on a tracked panel
+    return transfer_size >= SMARTDISPLAY_DMA_MIN_TRANSFER_SIZE || smartdisplay_dma_is_tracked(panel_handle);
 }
 
-esp_err_t smartdisplay_dma_flush_with_byteswap(lv_display_t *display, const lv_area_t *area, uint8_t *px_map, esp_lcd_panel_handle_t panel_handle, const char *panel_name)
+static esp_err_t smartdisplay_dma_flush_area(lv_display_t *display, const lv_area_t *area, uint8_t *px_map, esp_lcd_panel_handle_t panel_handle, const char *panel_name, bool swap)
 {
-    uint32_t pixels = lv_area_get_size(area);
-    size_t transfer_size = pixels * sizeof(uint16_t);
+#if DISPLAY_ROUND || defined(SMARTDISPLAY_RGB444)
+    // The round mask and RGB444 are features of the board panel
+    const bool board_display = display == smartdisplay_get_lv_display(smartdisplay_get_default());
+#endif
+#ifdef SMARTDISPLAY_SHADOW_FRAMEBUFFER
+    // Only send what differs from the content of the panel
+#if DISPLAY_ROUND
+    if (smartdisplay_shadow_flush(display, area, px_map, panel_handle, board_display, swap) == ESP_OK)
+#else
+    if (smartdisplay_shadow_flush(display, area, px_map, panel_handle, false, swap) == ESP_OK)
+#endif
+        return ESP_OK;
+#endif
+
+#if DISPLAY_ROUND
+    if (board_display)
+    {
+        smartdisplay_round_flush(display, area, px_map, panel_handle, swap);
+        return ESP_OK;
+    }
+#endif
 
-    // Perform byte swapping for SPI
-    uint16_t *p = (uint16_t *)px_map;
-    for (uint32_t i = 0; i < pixels; i++)
-        p[i] = (p[i] >> 8) | (p[i] << 8);
+    size_t transfer_size;
+#ifdef SMARTDISPLAY_RGB444
+    if (board_display)
+        // Packing to RGB444 also puts the bytes in SPI order
+        transfer_size = smartdisplay_rgb444_pack(area, px_map);
+    else
+#endif
+    {
+        uint32_t pixels = lv_area_get_size(area);
+        transfer_size = pixels * sizeof(uint16_t);
+
+        // Perform byte swapping for SPI
+        if (swap)
+        {
+            uint16_t *p = (uint16_t *)px_map;
+            for (uint32_t i = 0; i < pixels; i++)
+                p[i] = (p[i] >> 8) | (p[i] << 8);
+        }
+    }
 
     // Check if DMA is worth it for this transfer size
-    if (!smartdisplay_dma_should_use_for_size(transfer_size))
+    if (!smartdisplay_dma_should_use_for_size(panel_handle, transfer_size))
     {
         // Transfer too small for DMA, use direct transfer
-        ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map));
+        smartdisplay_dma_draw_direct(panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map);
         lv_display_flush_ready(display);
         return ESP_OK;
     }
 
     // Try DMA first, fall back to direct transfer if it fails
-    esp_err_t ret = smartdisplay_dma_draw_bitmap(area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map, smartdisplay_dma_lvgl_flush_callback, display, false);
+    esp_err_t ret = smartdisplay_dma_draw_bitmap(panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map, smartdisplay_dma_lvgl_flush_callback, display, false);
     if (ret == ESP_OK)
     {
         // DMA transfer initiated successfully, callback will handle flush_ready
@@ -51,14 +643,24 @@ esp_err_t smartdisplay_dma_flush_with_byteswap(lv_display_t *display, const lv_a
 
     // DMA failed, use direct transfer
     log_w("DMA transfer failed for %s, using direct transfer", panel_name);
-    ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map));
+    smartdisplay_dma_draw_direct(panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map);
     lv_display_flush_ready(display);
     return ESP_OK;
 }
 
-esp_err_t smartdisplay_dma_init_with_logging(esp_lcd_panel_handle_t panel_handle, const char *panel_name)
+esp_err_t smartdisplay_dma_flush_with_byteswap(lv_display_t *display, const lv_area_t *area, uint8_t *px_map, esp_lcd_panel_handle_t panel_handle, const char *panel_name)
+{
+    return smartdisplay_dma_flush_area(display, area, px_map, panel_handle, panel_name, true);
+}
+
+esp_err_t smartdisplay_dma_flush_no_byteswap(lv_display_t *display, const lv_area_t *area, uint8_t *px_map, esp_lcd_panel_handle_t panel_handle, const char *panel_name)
+{
+    return smartdisplay_dma_flush_area(display, area, px_map, panel_handle, panel_name, false);
+}
+
+esp_err_t smartdisplay_dma_init_with_logging(esp_lcd_panel_handle_t panel_handle, const char *panel_name, bool te_sync)
 {
-    esp_err_t dma_init_result = smartdisplay_dma_init(panel_handle);
+    esp_err_t dma_init_result = smartdisplay_dma_init(panel_handle, te_sync);
     if (dma_init_result == ESP_OK)
         log_i("DMA initialized successfully for %s display", panel_name);
     else
@@ -67,7 +669,14 @@ esp_err_t smartdisplay_dma_init_with_logging(esp_lcd_panel_handle_t panel_handle
     return dma_init_result;
 }
 
-void smartdisplay_dma_rotation_callback(bool success, void *user_data)
+// Display and rotated copy of a flushed area, freed when its transfer completes
+typedef struct
+{
+    lv_display_t *display;
+    void *rotation_buffer;
+} rotation_callback_data_t;
+
+static void smartdisplay_dma_rotation_callback(bool success, void *user_data)
 {
     rotation_callback_data_t *data = (rotation_callback_data_t *)user_data;
     if (!success)
@@ -77,12 +686,42 @@ void smartdisplay_dma_rotation_callback(bool success, void *user_data)
     free(data->rotation_buffer);
 
     // Signal LVGL that flush is complete
-    lv_display_flush_ready(data->display);
+    smartdisplay_dma_flush_ready(data->display);
 
     // Free the callback data structure
     free(data);
 }
 
+void smartdisplay_rotate_area(const lv_display_t *display, const lv_area_t *area, lv_area_t *panel_area)
+{
+    const int32_t w = lv_area_get_width(area);
+    const int32_t h = lv_area_get_height(area);
+    switch (display->rotation)
+    {
+    case LV_DISPLAY_ROTATION_90:
+        panel_area->x1 = area->y1;
+        panel_area->y1 = display->ver_res - area->x1 - w;
+        panel_area->x2 = panel_area->x1 + h - 1;
+        panel_area->y2 = panel_area->y1 + w - 1;
+        break;
+    case LV_DISPLAY_ROTATION_180:
+        panel_area->x1 = display->hor_res - area->x1 - w;
+        panel_area->y1 = display->ver_res - area->y1 - h;
+        panel_area->x2 = panel_area->x1 + w - 1;
+        panel_area->y2 = panel_area->y1 + h - 1;
+        break;
+    case LV_DISPLAY_ROTATION_270:
+        panel_area->x1 = display->hor_res - area->y2 - 1;
+        panel_area->y1 = area->x2 - w + 1;
+        panel_area->x2 = panel_area->x1 + h - 1;
+        panel_area->y2 = panel_area->y1 + w - 1;
+        break;
+    default:
+        *panel_area = *area;
+        break;
+    }
+}
+
 esp_err_t smartdisplay_dma_flush_with_rotation(lv_display_t *display, const lv_area_t *area, uint8_t *px_map, esp_lcd_panel_handle_t panel_handle, const char *panel_name)
 {
     lv_display_rotation_t rotation = lv_display_get_rotation(display);
@@ -91,16 +730,16 @@ esp_err_t smartdisplay_dma_flush_with_rotation(lv_display_t *display, const lv_a
         // No rotation needed, use standard DMA path
         size_t transfer_size = lv_area_get_size(area) * sizeof(uint16_t);
 
-        if (!smartdisplay_dma_should_use_for_size(transfer_size))
+        if (!smartdisplay_dma_should_use_for_size(panel_handle, transfer_size))
         {
             // Transfer too small for DMA, use direct transfer
-            ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map));
+            smartdisplay_dma_draw_direct(panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map);
             lv_display_flush_ready(display);
             return ESP_OK;
         }
 
         // Try DMA first, fall back to direct transfer if it fails
-        esp_err_t ret = smartdisplay_dma_draw_bitmap(area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map, smartdisplay_dma_lvgl_flush_callback, display, false);
+        esp_err_t ret = smartdisplay_dma_draw_bitmap(panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map, smartdisplay_dma_lvgl_flush_callback, display, false);
         if (ret == ESP_OK)
         {
             // DMA transfer initiated successfully, callback will handle flush_ready
@@ -109,18 +748,40 @@ esp_err_t smartdisplay_dma_flush_with_rotation(lv_display_t *display, const lv_a
 
         // DMA failed, use direct transfer
         log_w("DMA transfer failed for %s, using direct transfer", panel_name);
-        ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map));
+        smartdisplay_dma_draw_direct(panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map);
         lv_display_flush_ready(display);
         return ESP_OK;
     }
 
-    // Rotated - need to create rotation buffer
+    // Rotated - calculate the destination window in panel coordinates
     int32_t w = lv_area_get_width(area);
     int32_t h = lv_area_get_height(area);
+    lv_area_t panel_area;
+    smartdisplay_rotate_area(display, area, &panel_area);
+    const int x_start = panel_area.x1;
+    const int y_start = panel_area.y1;
+    const int x_end = panel_area.x2 + 1;
+    const int y_end = panel_area.y2 + 1;
+
     lv_color_format_t cf = lv_display_get_color_format(display);
     uint32_t px_size = lv_color_format_get_size(cf);
     size_t buf_size = w * h * px_size;
+    uint32_t w_stride = lv_draw_buf_width_to_stride(w, cf);
+
+    // Rotate straight from px_map into the DMA staging buffer, one chunk at a time
+    if (px_size == sizeof(uint16_t) && smartdisplay_dma_should_use_for_size(panel_handle, buf_size))
+    {
+        esp_err_t ret = smartdisplay_dma_draw_bitmap_rotated(panel_handle, x_start, y_start, x_end, y_end, px_map, w, h, w_stride, rotation, smartdisplay_dma_lvgl_flush_callback, display, false);
+        if (ret == ESP_OK)
+        {
+            // DMA transfer queued, callback will handle flush_ready
+            return ESP_OK;
+        }
+
+        log_d("Streaming rotation not available for %s (%s), using rotation buffer", panel_name, esp_err_to_name(ret));
+    }
 
+    // Fallback: rotate into a temporary buffer and transfer directly
     log_v("alloc rotation buffer to: %u bytes", buf_size);
     void *rotation_buffer = heap_caps_malloc(buf_size, LVGL_BUFFER_MALLOC_FLAGS);
     if (rotation_buffer == NULL)
@@ -129,92 +790,24 @@ esp_err_t smartdisplay_dma_flush_with_rotation(lv_display_t *display, const lv_a
         return ESP_ERR_NO_MEM;
     }
 
-    uint32_t w_stride = lv_draw_buf_width_to_stride(w, cf);
-    uint32_t h_stride = lv_draw_buf_width_to_stride(h, cf);
-
-    switch (rotation)
+    uint32_t dest_stride = lv_draw_buf_width_to_stride(x_end - x_start, cf);
+    lv_draw_sw_rotate(px_map, rotation_buffer, w, h, w_stride, dest_stride, rotation, cf);
+    if (smartdisplay_dma_is_tracked(panel_handle))
     {
-    case LV_DISPLAY_ROTATION_90:
-        lv_draw_sw_rotate(px_map, rotation_buffer, w, h, w_stride, h_stride, rotation, cf);
-
-        // Try DMA first for rotated data
-        if (smartdisplay_dma_should_use_for_size(buf_size))
-        {
-            rotation_callback_data_t *callback_data = heap_caps_malloc(sizeof(rotation_callback_data_t), MALLOC_CAP_DEFAULT);
-            if (callback_data != NULL)
-            {
-                callback_data->display = display;
-                callback_data->rotation_buffer = rotation_buffer;
-
-                esp_err_t ret = smartdisplay_dma_draw_bitmap(area->y1, display->ver_res - area->x1 - w, area->y1 + h, display->ver_res - area->x1, rotation_buffer, smartdisplay_dma_rotation_callback, callback_data, false);
-                if (ret == ESP_OK)
-                {
-                    // DMA transfer initiated, callback will free the buffer and handle completion
-                    return ESP_OK;
-                }
-                free(callback_data);
-            }
-            log_w("DMA transfer failed for 90° rotation on %s, using direct transfer", panel_name);
-        }
-        ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(panel_handle, area->y1, display->ver_res - area->x1 - w, area->y1 + h, display->ver_res - area->x1, rotation_buffer));
-        break;
-
-    case LV_DISPLAY_ROTATION_180:
-        lv_draw_sw_rotate(px_map, rotation_buffer, w, h, w_stride, w_stride, rotation, cf);
-
-        // Try DMA first for rotated data
-        if (smartdisplay_dma_should_use_for_size(buf_size))
+        // The worker sends the rotation buffer, the callback frees it
+        rotation_callback_data_t *data = malloc(sizeof(rotation_callback_data_t));
+        if (data != NULL)
         {
-            rotation_callback_data_t *callback_data = heap_caps_malloc(sizeof(rotation_callback_data_t), MALLOC_CAP_DEFAULT);
-            if (callback_data != NULL)
-            {
-                callback_data->display = display;
-                callback_data->rotation_buffer = rotation_buffer;
-
-                esp_err_t ret = smartdisplay_dma_draw_bitmap(display->hor_res - area->x1 - w, display->ver_res - area->y1 - h, display->hor_res - area->x1, display->ver_res - area->y1, rotation_buffer, smartdisplay_dma_rotation_callback, callback_data, false);
-                if (ret == ESP_OK)
-                {
-                    // DMA transfer initiated, callback will free the buffer and handle completion
-                    return ESP_OK;
-                }
-                free(callback_data);
-            }
-            log_w("DMA transfer failed for 180° rotation on %s, using direct transfer", panel_name);
-        }
-        ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(panel_handle, display->hor_res - area->x1 - w, display->ver_res - area->y1 - h, display->hor_res - area->x1, display->ver_res - area->y1, rotation_buffer));
-        break;
+            *data = (rotation_callback_data_t){.display = display, .rotation_buffer = rotation_buffer};
+            if (smartdisplay_dma_draw_bitmap(panel_handle, x_start, y_start, x_end, y_end, rotation_buffer, smartdisplay_dma_rotation_callback, data, false) == ESP_OK)
+                return ESP_OK;
 
-    case LV_DISPLAY_ROTATION_270:
-        lv_draw_sw_rotate(px_map, rotation_buffer, w, h, w_stride, h_stride, rotation, cf);
-
-        // Try DMA first for rotated data
-        if (smartdisplay_dma_should_use_for_size(buf_size))
-        {
-            rotation_callback_data_t *callback_data = heap_caps_malloc(sizeof(rotation_callback_data_t), MALLOC_CAP_DEFAULT);
-            if (callback_data != NULL)
-            {
-                callback_data->display = display;
-                callback_data->rotation_buffer = rotation_buffer;
-
-                esp_err_t ret = smartdisplay_dma_draw_bitmap(display->hor_res - area->y2 - 1, area->x2 - w + 1, display->hor_res - area->y2 - 1 + h, area->x2 + 1, rotation_buffer, smartdisplay_dma_rotation_callback, callback_data, false);
-                if (ret == ESP_OK)
-                {
-                    // DMA transfer initiated, callback will free the buffer and handle completion
-                    return ESP_OK;
-                }
-                free(callback_data);
-            }
-            log_w("DMA transfer failed for 270° rotation on %s, using direct transfer", panel_name);
+            free(data);
         }
-        ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(panel_handle, display->hor_res - area->y2 - 1, area->x2 - w + 1, display->hor_res - area->y2 - 1 + h, area->x2 + 1, rotation_buffer));
-        break;
-
-    default:
-        free(rotation_buffer);
-        return ESP_ERR_INVALID_ARG;
     }
 
-    // If we reach here, DMA was not used or failed, so we need to free the buffer and signal flush ready
+    smartdisplay_dma_draw_direct(panel_handle, x_start, y_start, x_end, y_end, rotation_buffer);
+
     free(rotation_buffer);
     lv_display_flush_ready(display);
     return ESP_OK;
@@ -0,0 +1,522 @@
+#if defined(DISPLAY_ST7262_PAR) || defined(DISPLAY_ST7701_PAR)
+
+#include <esp32_smartdisplay_rgb.h>
+#include <esp32_smartdisplay.h>
+#include <esp_lcd_panel_ops.h>
+#include <esp_timer.h>
+#include <stdatomic.h>
+#if defined(SMARTDISPLAY_RGB_REFRESH_ON_DEMAND) && !defined(SMARTDISPLAY_RGB_DIRECT_MODE)
+#include <esp32_smartdisplay_dma_helpers.h>
+#endif
+#ifdef SMARTDISPLAY_RGB_BLIT
+#include <esp32_smartdisplay_dma_helpers.h>
+#include <esp_cache.h>
+#include <string.h>
+#if !defined(SMARTDISPLAY_RGB_DIRECT_MODE) && (DISPLAY_SWAP_XY || DISPLAY_MIRROR_X || DISPLAY_MIRROR_Y)
+#error "SMARTDISPLAY_RGB_BLIT writes the framebuffer in the orientation of the panel, it can not be combined with DISPLAY_SWAP_XY, DISPLAY_MIRROR_X or DISPLAY_MIRROR_Y"
+#endif
+#endif
+
+// Underruns are only seen on the copies to the bounce buffers, the LCD peripheral keeps its timing when it reads the PSRAM too late
+#if !defined(SMARTDISPLAY_RGB_BOUNCE_BUFFER_LINES) && (defined(SMARTDISPLAY_RGB_RESTART_ON_UNDERRUN) || defined(SMARTDISPLAY_RGB_PCLK_GOVERNOR))
+#error "SMARTDISPLAY_RGB_RESTART_ON_UNDERRUN and SMARTDISPLAY_RGB_PCLK_GOVERNOR need SMARTDISPLAY_RGB_BOUNCE_BUFFER_LINES"
+#endif
+
+#ifdef SMARTDISPLAY_RGB_RESTART_ON_UNDERRUN
+// Polling interval of the restart requested by the frame done interrupt
+#ifndef SMARTDISPLAY_RGB_RESTART_POLL_MS
+#define SMARTDISPLAY_RGB_RESTART_POLL_MS 10
+#endif
+#endif
+
+// State of the RGB panel, there is a single one: the board display
+static struct
+{
+    lv_display_t *display;
+    esp_lcd_panel_handle_t rgb_panel;
+    const uint16_t *scanout_fb;
+    int32_t h_res;
+    int32_t v_res;
+    bool bounce_buffer;
+    uint64_t clocks_per_frame;
+    uint32_t nominal_pclk_hz;
+    uint32_t bounce_clocks; // Pixel clocks to scan out a bounce buffer
+    uint32_t blank_clocks;  // Pixel clocks from the end of the last line to the vsync
+    // Bounce buffer timing, only written by the interrupts once the panel runs
+    uint32_t underrun_margin_us; // The last copy of a frame finishing closer to the vsync was too late
+    uint32_t late_margin_us;     // The last copy of a frame finishing closer to the vsync used more than half of its slack
+    volatile bool bounce_frame_finished;
+    volatile uint32_t bounce_frame_finish_us;
+    atomic_uint_least32_t pending_frame_time_us; // Frame time of a new pixel clock, picked up by the frame done interrupt
+    volatile bool restart_pending; // Set by the frame done interrupt, the restart is not allowed there
+    volatile smartdisplay_rgb_stats_t stats;
+} rgb;
+
+// State of the pixel clock governor
+static struct
+{
+    lv_timer_t *timer;
+    smartdisplay_rgb_governor_config_t config;
+    uint32_t late_frames;
+    uint32_t underruns;
+    uint32_t quiet_periods;
+    bool heavy;
+} rgb_governor;
+
+#if defined(SMARTDISPLAY_RGB_REFRESH_ON_DEMAND) && !defined(SMARTDISPLAY_RGB_DIRECT_MODE)
+// Set once a refresh is ready, the frame is scanned out by the refresh or by the completion of its last band, whichever is later
+static atomic_bool rgb_refresh_pending;
+
+static void smartdisplay_rgb_refresh_pending()
+{
+    if (atomic_exchange(&rgb_refresh_pending, false))
+        esp_lcd_rgb_panel_refresh(rgb.rgb_panel);
+}
+
+// The DMA manager has transferred the last band of a refresh, of any display
+static void smartdisplay_rgb_frame_flushed(lv_display_t *display)
+{
+    if (display == rgb.display)
+        smartdisplay_rgb_refresh_pending();
+}
+
+static void smartdisplay_rgb_refr_ready(lv_event_t *e)
+{
+    lv_display_t *display = lv_event_get_target(e);
+    atomic_store(&rgb_refresh_pending, true);
+    // A band still being transferred scans out the frame from its completion
+    if (!display->flushing)
+        smartdisplay_rgb_refresh_pending();
+}
+#endif
+
+#ifdef SMARTDISPLAY_RGB_RESTART_ON_UNDERRUN
+static void smartdisplay_rgb_restart_check(lv_timer_t *timer)
+{
+    if (!rgb.restart_pending)
+        return;
+
+    rgb.restart_pending = false;
+    const esp_err_t res = smartdisplay_rgb_restart();
+    if (res != ESP_OK)
+        log_e("Unable to restart the RGB transmission: %s", esp_err_to_name(res));
+}
+#endif
+
+#ifdef SMARTDISPLAY_RGB_DIRECT_MODE
+// State of the framebuffer swap
+static struct
+{
+    volatile bool swap_pending;
+} rgb_direct;
+
+static void smartdisplay_rgb_direct_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
+{
+    // LVGL renders into the framebuffer itself, only the last area of a frame needs a swap
+    if (!lv_display_flush_is_last(display))
+    {
+        lv_display_flush_ready(display);
+        return;
+    }
+
+    // Passing one of the framebuffers makes the driver scan it out from the next frame, no copy is made
+    const esp_err_t res = esp_lcd_panel_draw_bitmap(rgb.rgb_panel, 0, 0, display->hor_res, display->ver_res, px_map);
+    if (res != ESP_OK)
+    {
+        log_e("Unable to swap framebuffer: %s", esp_err_to_name(res));
+        lv_display_flush_ready(display);
+        return;
+    }
+
+    // Flush is completed by the next vsync
+    rgb.scanout_fb = (const uint16_t *)px_map;
+    rgb_direct.swap_pending = true;
+#ifdef SMARTDISPLAY_RGB_REFRESH_ON_DEMAND
+    esp_lcd_rgb_panel_refresh(rgb.rgb_panel);
+#endif
+}
+
+// LVGL renders into the framebuffers as they are scanned out, a rotation is reverted when it is set
+static void smartdisplay_rgb_direct_resolution_changed(lv_event_t *e)
+{
+    lv_display_t *display = lv_event_get_target(e);
+    if (lv_display_get_rotation(display) == LV_DISPLAY_ROTATION_0)
+        return;
+
+    log_w("Rotation is not supported in RGB direct mode");
+    lv_display_set_rotation(display, LV_DISPLAY_ROTATION_0);
+}
+
+esp_err_t smartdisplay_rgb_direct_mode_init(lv_display_t *display)
+{
+    log_v("display:0x%08x", display);
+    if (rgb.rgb_panel == NULL)
+        return ESP_ERR_INVALID_STATE;
+
+    void *fb0, *fb1;
+    esp_err_t res;
+    if ((res = esp_lcd_rgb_panel_get_frame_buffer(rgb.rgb_panel, 2, &fb0, &fb1)) != ESP_OK)
+    {
+        log_e("Unable to get the framebuffers: %s", esp_err_to_name(res));
+        return res;
+    }
+
+    rgb_direct.swap_pending = false;
+
+    const uint32_t fb_size = display->hor_res * display->ver_res * lv_color_format_get_size(lv_display_get_color_format(display));
+    log_d("framebuffers: 0x%08x, 0x%08x (%d bytes)", fb0, fb1, fb_size);
+    lv_display_set_buffers(display, fb0, fb1, fb_size, LV_DISPLAY_RENDER_MODE_DIRECT);
+    display->flush_cb = smartdisplay_rgb_direct_flush;
+    if (lv_display_get_rotation(display) != LV_DISPLAY_ROTATION_0)
+    {
+        log_w("Rotation is not supported in RGB direct mode");
+        lv_display_set_rotation(display, LV_DISPLAY_ROTATION_0);
+    }
+
+    lv_display_add_event_cb(display, smartdisplay_rgb_direct_resolution_changed, LV_EVENT_RESOLUTION_CHANGED, NULL);
+    return ESP_OK;
+}
+#endif
+
+#if defined(SMARTDISPLAY_RGB_BLIT) && !defined(SMARTDISPLAY_RGB_DIRECT_MODE)
+void smartdisplay_rgb_blit_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
+{
+    // The framebuffer is written by the CPU, it is the only one when not in direct mode
+    uint16_t *fb = (uint16_t *)rgb.scanout_fb;
+    if (fb == NULL)
+    {
+        log_e("No framebuffer");
+        lv_display_flush_ready(display);
+        return;
+    }
+
+    // Destination window in panel coordinates
+    const lv_display_rotation_t rotation = lv_display_get_rotation(display);
+    const int32_t w = lv_area_get_width(area);
+    const int32_t h = lv_area_get_height(area);
+    lv_area_t panel_area;
+    smartdisplay_rotate_area(display, area, &panel_area);
+    int32_t x_start = panel_area.x1;
+    int32_t y_start = panel_area.y1;
+    int32_t x_end = panel_area.x2 + 1;
+    int32_t y_end = panel_area.y2 + 1;
+
+#if defined(DISPLAY_GAP_X) || defined(DISPLAY_GAP_Y)
+    // Same offset as the panel applies to its draws
+    x_start += DISPLAY_GAP_X;
+    x_end += DISPLAY_GAP_X;
+    y_start += DISPLAY_GAP_Y;
+    y_end += DISPLAY_GAP_Y;
+#endif
+
+    if (x_start < 0 || y_start < 0 || x_end > rgb.h_res || y_end > rgb.v_res)
+    {
+        log_e("Area outside of the framebuffer");
+        lv_display_flush_ready(display);
+        return;
+    }
+
+    const uint32_t fb_stride = rgb.h_res * sizeof(uint16_t);
+    uint8_t *dest = (uint8_t *)fb + y_start * fb_stride + x_start * sizeof(uint16_t);
+    const uint32_t src_stride = lv_draw_buf_width_to_stride(w, lv_display_get_color_format(display));
+    if (rotation == LV_DISPLAY_ROTATION_0)
+    {
+        const size_t row_size = w * sizeof(uint16_t);
+        for (int32_t y = 0; y < h; y++)
+            memcpy(dest + y * fb_stride, px_map + y * src_stride, row_size);
+    }
+    else
+        lv_draw_sw_rotate(px_map, dest, w, h, src_stride, fb_stride, rotation, LV_COLOR_FORMAT_RGB565);
+
+    // The LCD peripheral reads the framebuffer from PSRAM, bounce buffers are filled by the CPU through the cache
+    if (!rgb.bounce_buffer)
+    {
+        const esp_err_t res = esp_cache_msync((uint8_t *)fb + y_start * fb_stride, (y_end - y_start) * fb_stride, ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_UNALIGNED);
+        if (res != ESP_OK)
+            log_e("Unable to write back the framebuffer: %s", esp_err_to_name(res));
+    }
+
+    lv_display_flush_ready(display);
+}
+#endif
+
+#ifndef SMARTDISPLAY_RGB_REFRESH_ON_DEMAND
+// The copy of the last part of the frame to a bounce buffer is done
+static bool smartdisplay_rgb_bounce_frame_finish(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
+{
+    rgb.bounce_frame_finish_us = esp_timer_get_time();
+    rgb.bounce_frame_finished = true;
+    return false;
+}
+
+static bool smartdisplay_rgb_vsync(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
+{
+    return smartdisplay_rgb_frame_done(panel, (esp_lcd_rgb_panel_event_data_t *)edata, user_ctx);
+}
+
+// Called at the vsync. A bounce buffer is filled while the LCD peripheral reads the other one, so the last part of the frame
+// must have been copied before the LCD started reading it: a bounce buffer, the front porch and the vsync pulse before the vsync
+static void smartdisplay_rgb_check_bounce_frame()
+{
+    const uint32_t margin_us = (uint32_t)esp_timer_get_time() - rgb.bounce_frame_finish_us;
+    const bool finished = rgb.bounce_frame_finished;
+    rgb.bounce_frame_finished = false;
+
+    // The frame changing the pixel clock is not checked
+    const uint32_t pending_frame_time_us = atomic_exchange(&rgb.pending_frame_time_us, 0);
+    if (pending_frame_time_us != 0)
+    {
+        rgb.underrun_margin_us = (uint64_t)pending_frame_time_us * (rgb.bounce_clocks + rgb.blank_clocks) / rgb.clocks_per_frame;
+        rgb.late_margin_us = (uint64_t)pending_frame_time_us * (rgb.bounce_clocks * 3 / 2 + rgb.blank_clocks) / rgb.clocks_per_frame;
+        return;
+    }
+
+    if (!finished || margin_us < rgb.underrun_margin_us)
+    {
+        rgb.stats.underruns++;
+        rgb.stats.late_frames++;
+#ifdef SMARTDISPLAY_RGB_RESTART_ON_UNDERRUN
+        // Restarted from the LVGL task
+        rgb.restart_pending = true;
+#endif
+    }
+    else if (margin_us < rgb.late_margin_us)
+        rgb.stats.late_frames++;
+}
+#endif
+
+esp_err_t smartdisplay_rgb_init(lv_display_t *display, esp_lcd_panel_handle_t rgb_panel, const esp_lcd_rgb_panel_config_t *rgb_panel_config)
+{
+    log_v("display:0x%08x, rgb_panel:0x%08x, rgb_panel_config:0x%08x", display, rgb_panel, rgb_panel_config);
+    if (display == NULL || rgb_panel == NULL || rgb_panel_config == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    if (rgb.rgb_panel != NULL && rgb.rgb_panel != rgb_panel)
+    {
+        log_e("Only one RGB panel is supported");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const esp_lcd_rgb_timing_t *timings = &rgb_panel_config->timings;
+    const uint32_t clocks_per_line = timings->h_res + timings->hsync_pulse_width + timings->hsync_back_porch + timings->hsync_front_porch;
+    const uint64_t clocks_per_frame = (uint64_t)clocks_per_line * (timings->v_res + timings->vsync_pulse_width + timings->vsync_back_porch + timings->vsync_front_porch);
+    rgb.display = display;
+    rgb.rgb_panel = rgb_panel;
+    rgb.h_res = timings->h_res;
+    rgb.v_res = timings->v_res;
+    rgb.bounce_buffer = rgb_panel_config->bounce_buffer_size_px > 0;
+    rgb.clocks_per_frame = clocks_per_frame;
+    rgb.nominal_pclk_hz = timings->pclk_hz;
+    rgb.bounce_clocks = (uint64_t)rgb_panel_config->bounce_buffer_size_px * clocks_per_line / timings->h_res;
+    rgb.blank_clocks = (timings->vsync_front_porch + timings->vsync_pulse_width) * clocks_per_line;
+    // The frame done interrupt may already run
+    const uint32_t frame_time_us = clocks_per_frame * 1000000 / timings->pclk_hz;
+    atomic_store(&rgb.pending_frame_time_us, frame_time_us);
+    rgb.stats = (smartdisplay_rgb_stats_t){.pclk_hz = timings->pclk_hz};
+    log_d("frame time: %d us, bounce buffer: %d px", frame_time_us, rgb_panel_config->bounce_buffer_size_px);
+
+    // The first framebuffer is scanned out until the direct mode swaps them
+    void *fb;
+    if (esp_lcd_rgb_panel_get_frame_buffer(rgb_panel, 1, &fb) == ESP_OK)
+        rgb.scanout_fb = fb;
+    else
+        rgb.scanout_fb = NULL;
+
+#if defined(SMARTDISPLAY_RGB_REFRESH_ON_DEMAND) && !defined(SMARTDISPLAY_RGB_DIRECT_MODE)
+    // Scan out a frame once all bands of a refresh have been transferred
+    atomic_store(&rgb_refresh_pending, false);
+    smartdisplay_dma_set_frame_flushed_cb(smartdisplay_rgb_frame_flushed);
+    lv_display_add_event_cb(display, smartdisplay_rgb_refr_ready, LV_EVENT_REFR_READY, NULL);
+#endif
+
+#ifndef SMARTDISPLAY_RGB_REFRESH_ON_DEMAND
+    if (rgb.bounce_buffer)
+    {
+        // Replaces the frame done callback of the panel configuration, the vsync calls it
+        const esp_lcd_rgb_panel_event_callbacks_t callbacks = {
+            .on_vsync = smartdisplay_rgb_vsync,
+            .on_bounce_frame_finish = smartdisplay_rgb_bounce_frame_finish};
+        const esp_err_t res = esp_lcd_rgb_panel_register_event_callbacks(rgb_panel, &callbacks, display);
+        if (res != ESP_OK)
+        {
+            log_e("Unable to register the bounce buffer callbacks: %s", esp_err_to_name(res));
+            return res;
+        }
+    }
+#endif
+
+#ifdef SMARTDISPLAY_RGB_RESTART_ON_UNDERRUN
+    rgb.restart_pending = false;
+    lv_timer_create(smartdisplay_rgb_restart_check, SMARTDISPLAY_RGB_RESTART_POLL_MS, NULL);
+#endif
+
+#if defined(SMARTDISPLAY_RGB_PCLK_GOVERNOR) && !defined(SMARTDISPLAY_RGB_REFRESH_ON_DEMAND)
+    // Lower the refresh rate while the framebuffer can't be read in time
+    smartdisplay_rgb_governor_start(NULL);
+#endif
+
+    return ESP_OK;
+}
+
+esp_err_t smartdisplay_rgb_restart()
+{
+    if (rgb.rgb_panel == NULL)
+        return ESP_ERR_INVALID_STATE;
+
+    rgb.stats.restarts++;
+    return esp_lcd_rgb_panel_restart(rgb.rgb_panel);
+}
+
+static esp_err_t smartdisplay_rgb_set_pclk(uint32_t pclk_hz)
+{
+    if (pclk_hz == rgb.stats.pclk_hz)
+        return ESP_OK;
+
+    // Applied from the next frame
+    const esp_err_t res = esp_lcd_rgb_panel_set_pclk(rgb.rgb_panel, pclk_hz);
+    if (res != ESP_OK)
+    {
+        log_e("Unable to set the pixel clock: %s", esp_err_to_name(res));
+        return res;
+    }
+
+    log_d("pixel clock: %d Hz, %d Hz refresh", pclk_hz, (uint32_t)(pclk_hz / rgb.clocks_per_frame));
+    rgb.stats.pclk_hz = pclk_hz;
+    atomic_store(&rgb.pending_frame_time_us, (uint32_t)(rgb.clocks_per_frame * 1000000 / pclk_hz));
+    return ESP_OK;
+}
+
+#ifndef SMARTDISPLAY_RGB_REFRESH_ON_DEMAND
+static void smartdisplay_rgb_governor_check(lv_timer_t *timer)
+{
+    const uint32_t late_frames = rgb.stats.late_frames;
+    const uint32_t underruns = rgb.stats.underruns;
+    const uint32_t late = late_frames - rgb_governor.late_frames;
+    const bool underrun = underruns != rgb_governor.underruns;
+    rgb_governor.late_frames = late_frames;
+    rgb_governor.underruns = underruns;
+
+    const smartdisplay_rgb_governor_config_t *config = &rgb_governor.config;
+    uint32_t pclk_hz = rgb.stats.pclk_hz;
+    if (rgb_governor.heavy)
+    {
+        pclk_hz = config->min_pclk_hz;
+        rgb_governor.quiet_periods = 0;
+    }
+    else if (underrun || late >= config->late_frames_to_lower)
+    {
+        pclk_hz = LV_MAX(pclk_hz - LV_MIN(config->step_hz, pclk_hz), config->min_pclk_hz);
+        rgb_governor.quiet_periods = 0;
+    }
+    else if (late == 0 && pclk_hz < rgb.nominal_pclk_hz && ++rgb_governor.quiet_periods >= config->periods_to_raise)
+    {
+        pclk_hz = LV_MIN(pclk_hz + config->step_hz, rgb.nominal_pclk_hz);
+        rgb_governor.quiet_periods = 0;
+    }
+
+    smartdisplay_rgb_set_pclk(pclk_hz);
+}
+#endif
+
+esp_err_t smartdisplay_rgb_governor_start(const smartdisplay_rgb_governor_config_t *config)
+{
+    log_v("config:0x%08x", config);
+#ifdef SMARTDISPLAY_RGB_REFRESH_ON_DEMAND
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    if (rgb.rgb_panel == NULL)
+        return ESP_ERR_INVALID_STATE;
+
+    // Late frames are only seen on the bounce buffers
+    if (!rgb.bounce_buffer)
+        return ESP_ERR_NOT_SUPPORTED;
+
+    if (config == NULL)
+        rgb_governor.config = (smartdisplay_rgb_governor_config_t)SMARTDISPLAY_RGB_GOVERNOR_CONFIG_DEFAULT(rgb.nominal_pclk_hz);
+    else
+        rgb_governor.config = *config;
+
+    if (rgb_governor.config.min_pclk_hz == 0 || rgb_governor.config.min_pclk_hz > rgb.nominal_pclk_hz || rgb_governor.config.step_hz == 0 || rgb_governor.config.period_ms == 0)
+        return ESP_ERR_INVALID_ARG;
+
+    rgb_governor.late_frames = rgb.stats.late_frames;
+    rgb_governor.underruns = rgb.stats.underruns;
+    rgb_governor.quiet_periods = 0;
+    if (rgb_governor.timer == NULL)
+        rgb_governor.timer = lv_timer_create(smartdisplay_rgb_governor_check, rgb_governor.config.period_ms, NULL);
+    else
+        lv_timer_set_period(rgb_governor.timer, rgb_governor.config.period_ms);
+
+    return ESP_OK;
+#endif
+}
+
+esp_err_t smartdisplay_rgb_governor_stop()
+{
+    if (rgb_governor.timer == NULL)
+        return ESP_ERR_INVALID_STATE;
+
+    lv_timer_del(rgb_governor.timer);
+    rgb_governor.timer = NULL;
+    rgb_governor.heavy = false;
+    return smartdisplay_rgb_set_pclk(rgb.nominal_pclk_hz);
+}
+
+esp_err_t smartdisplay_rgb_governor_hint(bool heavy)
+{
+    log_v("heavy:%d", heavy);
+    if (rgb_governor.timer == NULL)
+        return ESP_ERR_INVALID_STATE;
+
+    rgb_governor.heavy = heavy;
+    // Lower the clock before the load starts
+    if (heavy)
+        lv_timer_ready(rgb_governor.timer);
+
+    return ESP_OK;
+}
+
+esp_err_t smartdisplay_rgb_get_stats(smartdisplay_rgb_stats_t *stats)
+{
+    if (stats == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    *stats = rgb.stats;
+    return ESP_OK;
+}
+
+esp_err_t smartdisplay_rgb_get_frame_buffer(const uint16_t **fb, int32_t *h_res, int32_t *v_res)
+{
+    if (fb == NULL || h_res == NULL || v_res == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    if (rgb.scanout_fb == NULL)
+        return ESP_ERR_INVALID_STATE;
+
+    *fb = rgb.scanout_fb;
+    *h_res = rgb.h_res;
+    *v_res = rgb.v_res;
+    return ESP_OK;
+}
+
+bool smartdisplay_rgb_frame_done(esp_lcd_panel_handle_t panel, esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
+{
+    rgb.stats.frames++;
+#ifndef SMARTDISPLAY_RGB_REFRESH_ON_DEMAND
+    if (rgb.bounce_buffer)
+        smartdisplay_rgb_check_bounce_frame();
+#endif
+
+#ifdef SMARTDISPLAY_RGB_DIRECT_MODE
+    // The new framebuffer is now being scanned out, the other one can be rendered into
+    if (rgb_direct.swap_pending)
+    {
+        rgb_direct.swap_pending = false;
+        lv_display_flush_ready((lv_display_t *)user_ctx);
+    }
+#endif
+    // When using DMA, lv_display_flush_ready() is called by DMA callbacks
+    return false;
+}
+
+#endif
@@ -8,7 +8,10 @@
 
 #include <inttypes.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "driver/gpio.h"
+#include "esp_attr.h"
 #include "esp_bit_defs.h"
 #include "esp_check.h"
 #include "esp_log.h"
@@ -16,6 +19,38 @@
 #include "esp_io_expander.h"
 
 #define VALID_IO_COUNT(handle)      ((handle)->config.io_count <= IO_COUNT_MAX ? (handle)->config.io_count : IO_COUNT_MAX)
+#define OUTPUT_BURST_MAX            (32)    // Values written to output register in one burst
+
+#ifndef IO_EXPANDER_ASYNC_QUEUE_LEN
+#define IO_EXPANDER_ASYNC_QUEUE_LEN     (8)
+#endif
+#ifndef IO_EXPANDER_ASYNC_TASK_PRIORITY
+#define IO_EXPANDER_ASYNC_TASK_PRIORITY (5)
+#endif
+#ifndef IO_EXPANDER_ASYNC_TASK_STACK
+#define IO_EXPANDER_ASYNC_TASK_STACK    (3072)
+#endif
+#ifndef IO_EXPANDER_INTERRUPT_TASK_PRIORITY
+#define IO_EXPANDER_INTERRUPT_TASK_PRIORITY (6)
+#endif
+#ifndef IO_EXPANDER_INTERRUPT_TASK_STACK
+#define IO_EXPANDER_INTERRUPT_TASK_STACK    (3072)
+#endif
+#ifndef IO_EXPANDER_INTERRUPT_POLL_MS
+#define IO_EXPANDER_INTERRUPT_POLL_MS       (10)    // Input register polling while a read fails or the INT line stays low
+#endif
+
+/**
+ * @brief Asynchronous write
+ *
+ */
+typedef struct {
+    uint32_t pin_num_mask;
+    uint32_t level_mask;
+    esp_io_expander_async_cb_t cb;
+    void *user_ctx;
+    SemaphoreHandle_t stopped;  /* Set to stop the worker task, given when it exits */
+} async_write_t;
 
 /**
  * @brief Register type
@@ -29,8 +64,50 @@ typedef enum {
 
 static char *TAG = "io_expander";
 
+/* Guards the creation of the lock of a device */
+static portMUX_TYPE lock_create_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
 static esp_err_t write_reg(esp_io_expander_handle_t handle, reg_type_t reg, uint32_t value);
 static esp_err_t read_reg(esp_io_expander_handle_t handle, reg_type_t reg, uint32_t *value);
+static esp_err_t check_output_mode(esp_io_expander_handle_t handle, uint32_t pin_num_mask);
+static esp_err_t write_output_burst(esp_io_expander_handle_t handle, const uint32_t *values, size_t count);
+static esp_err_t set_output(esp_io_expander_handle_t handle, uint32_t pin_num_mask, uint32_t level_mask);
+static esp_err_t set_dir(esp_io_expander_handle_t handle, uint32_t pin_num_mask, esp_io_expander_dir_t direction);
+static esp_err_t set_level_sequence(esp_io_expander_handle_t handle, uint32_t pin_num_mask, const uint32_t *levels, size_t count);
+static esp_err_t get_level(esp_io_expander_handle_t handle, uint32_t pin_num_mask, uint32_t *level_mask);
+static esp_err_t async_init(esp_io_expander_handle_t handle);
+static void interrupt_task(void *arg);
+static void interrupt_isr(void *arg);
+static void interrupt_deinit(esp_io_expander_handle_t handle);
+
+/**
+ * @brief Take the lock serializing the register accesses, it is created by the first call on the device
+ */
+static esp_err_t lock(esp_io_expander_handle_t handle)
+{
+    if (!handle->lock) {
+        /* Tasks making their first call at the same time keep the same mutex */
+        SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+        ESP_RETURN_ON_FALSE(mutex, ESP_ERR_NO_MEM, TAG, "No memory");
+        portENTER_CRITICAL(&lock_create_spinlock);
+        if (!handle->lock) {
+            handle->lock = mutex;
+            mutex = NULL;
+        }
+        portEXIT_CRITICAL(&lock_create_spinlock);
+        if (mutex) {
+            vSemaphoreDelete(mutex);
+        }
+    }
+    xSemaphoreTake(handle->lock, portMAX_DELAY);
+
+    return ESP_OK;
+}
+
+static inline void unlock(esp_io_expander_handle_t handle)
+{
+    xSemaphoreGive(handle->lock);
+}
 
 esp_err_t esp_io_expander_set_dir(esp_io_expander_handle_t handle, uint32_t pin_num_mask, esp_io_expander_dir_t direction)
 {
@@ -39,74 +116,73 @@ esp_err_t esp_io_expander_set_dir(esp_io_expander_handle_t handle, uint32_t pin_
         ESP_LOGW(TAG, "Pin num mask out of range, bit higher than %d won't work", VALID_IO_COUNT(handle) - 1);
     }
 
-    bool is_output = (direction == IO_EXPANDER_OUTPUT) ? true : false;
-    uint32_t dir_reg, temp;
-    ESP_RETURN_ON_ERROR(read_reg(handle, REG_DIRECTION, &dir_reg), TAG, "Read direction reg failed");
-    temp = dir_reg;
-    if ((is_output && !handle->config.flags.dir_out_bit_zero) || (!is_output && handle->config.flags.dir_out_bit_zero)) {
-        /* 1. Output && Set 1 to output */
-        /* 2. Input && Set 1 to input */
-        dir_reg |= pin_num_mask;
-    } else {
-        /* 3. Output && Set 0 to output */
-        /* 4. Input && Set 0 to input */
-        dir_reg &= ~pin_num_mask;
-    }
-    /* Write to reg only when different */
-    if (dir_reg != temp) {
-        ESP_RETURN_ON_ERROR(write_reg(handle, REG_DIRECTION, dir_reg), TAG, "Write direction reg failed");
-    }
+    ESP_RETURN_ON_ERROR(lock(handle), TAG, "Lock failed");
+    esp_err_t ret = set_dir(handle, pin_num_mask, direction);
+    unlock(handle);
 
-    return ESP_OK;
+    return ret;
 }
 
 esp_err_t esp_io_expander_set_level(esp_io_expander_handle_t handle, uint32_t pin_num_mask, uint8_t level)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+
+    return esp_io_expander_set_levels(handle, pin_num_mask, level ? pin_num_mask : 0);
+}
+
+esp_err_t esp_io_expander_set_levels(esp_io_expander_handle_t handle, uint32_t pin_num_mask, uint32_t level_mask)
 {
     ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
     if (pin_num_mask >= BIT64(VALID_IO_COUNT(handle))) {
         ESP_LOGW(TAG, "Pin num mask out of range, bit higher than %d won't work", VALID_IO_COUNT(handle) - 1);
     }
 
-    uint32_t dir_reg, dir_bit;
-    ESP_RETURN_ON_ERROR(read_reg(handle, REG_DIRECTION, &dir_reg), TAG, "Read direction reg failed");
+    ESP_RETURN_ON_ERROR(lock(handle), TAG, "Lock failed");
+    esp_err_t ret = set_output(handle, pin_num_mask, level_mask);
+    unlock(handle);
 
-    uint8_t io_count = VALID_IO_COUNT(handle);
-    /* Check every target pin's direction, must be in output mode */
-    for (int i = 0; i < io_count; i++) {
-        if (pin_num_mask & BIT(i)) {
-            dir_bit = dir_reg & BIT(i);
-            /* Check whether it is in input mode */
-            if ((dir_bit && handle->config.flags.dir_out_bit_zero) || (!dir_bit && !handle->config.flags.dir_out_bit_zero)) {
-                /* 1. 1 && Set 1 to input */
-                /* 2. 0 && Set 0 to input */
-                ESP_LOGE(TAG, "Pin[%d] can't set level in input mode", i);
-                return ESP_ERR_INVALID_STATE;
-            }
-        }
-    }
+    return ret;
+}
 
-    uint32_t output_reg, temp;
-    /* Read the current output level */
-    ESP_RETURN_ON_ERROR(read_reg(handle, REG_OUTPUT, &output_reg), TAG, "Read Output reg failed");
-    temp = output_reg;
-    /* Set expected output level */
-    if ((level && !handle->config.flags.output_high_bit_zero) || (!level && handle->config.flags.output_high_bit_zero)) {
-        /* 1. High level && Set 1 to output high */
-        /* 2. Low level && Set 1 to output low */
-        output_reg |= pin_num_mask;
-    } else {
-        /* 3. High level && Set 0 to output high */
-        /* 4. Low level && Set 0 to output low */
-        output_reg &= ~pin_num_mask;
-    }
-    /* Write to reg only when different */
-    if (output_reg != temp) {
-        ESP_RETURN_ON_ERROR(write_reg(handle, REG_OUTPUT, output_reg), TAG, "Write Output reg failed");
+esp_err_t esp_io_expander_set_levels_async(esp_io_expander_handle_t handle, uint32_t pin_num_mask, uint32_t level_mask,
+                                           esp_io_expander_async_cb_t cb, void *user_ctx)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+    if (pin_num_mask >= BIT64(VALID_IO_COUNT(handle))) {
+        ESP_LOGW(TAG, "Pin num mask out of range, bit higher than %d won't work", VALID_IO_COUNT(handle) - 1);
     }
 
+    ESP_RETURN_ON_ERROR(lock(handle), TAG, "Lock failed");
+    esp_err_t ret = handle->async.task ? ESP_OK : async_init(handle);
+    unlock(handle);
+    ESP_RETURN_ON_ERROR(ret, TAG, "Async init failed");
+
+    const async_write_t write = {
+        .pin_num_mask = pin_num_mask,
+        .level_mask = level_mask,
+        .cb = cb,
+        .user_ctx = user_ctx,
+    };
+    ESP_RETURN_ON_FALSE(xQueueSend(handle->async.queue, &write, portMAX_DELAY) == pdTRUE, ESP_FAIL, TAG, "Queue write failed");
+
     return ESP_OK;
 }
 
+esp_err_t esp_io_expander_set_level_sequence(esp_io_expander_handle_t handle, uint32_t pin_num_mask, const uint32_t *levels, size_t count)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+    ESP_RETURN_ON_FALSE(levels || !count, ESP_ERR_INVALID_ARG, TAG, "Invalid levels");
+    if (pin_num_mask >= BIT64(VALID_IO_COUNT(handle))) {
+        ESP_LOGW(TAG, "Pin num mask out of range, bit higher than %d won't work", VALID_IO_COUNT(handle) - 1);
+    }
+
+    ESP_RETURN_ON_ERROR(lock(handle), TAG, "Lock failed");
+    esp_err_t ret = set_level_sequence(handle, pin_num_mask, levels, count);
+    unlock(handle);
+
+    return ret;
+}
+
 esp_err_t esp_io_expander_get_level(esp_io_expander_handle_t handle, uint32_t pin_num_mask, uint32_t *level_mask)
 {
     ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
@@ -115,17 +191,11 @@ esp_err_t esp_io_expander_get_level(esp_io_expander_handle_t handle, uint32_t pi
         ESP_LOGW(TAG, "Pin num mask out of range, bit higher than %d won't work", VALID_IO_COUNT(handle) - 1);
     }
 
-    uint32_t input_reg;
-    ESP_RETURN_ON_ERROR(read_reg(handle, REG_INPUT, &input_reg), TAG, "Read input reg failed");
-    if (!handle->config.flags.input_high_bit_zero) {
-        /* Get 1 when input high level */
-        *level_mask = input_reg & pin_num_mask;
-    } else {
-        /* Get 0 when input high level */
-        *level_mask = ~input_reg & pin_num_mask;
-    }
+    ESP_RETURN_ON_ERROR(lock(handle), TAG, "Lock failed");
+    esp_err_t ret = get_level(handle, pin_num_mask, level_mask);
+    unlock(handle);
 
-    return ESP_OK;
+    return ret;
 }
 
 esp_err_t esp_io_expander_print_state(esp_io_expander_handle_t handle)
@@ -134,9 +204,16 @@ esp_err_t esp_io_expander_print_state(esp_io_expander_handle_t handle)
 
     uint8_t io_count = VALID_IO_COUNT(handle);
     uint32_t input_reg, output_reg, dir_reg;
-    ESP_RETURN_ON_ERROR(read_reg(handle, REG_INPUT, &input_reg), TAG, "Read input reg failed");
-    ESP_RETURN_ON_ERROR(read_reg(handle, REG_OUTPUT, &output_reg), TAG, "Read output reg failed");
-    ESP_RETURN_ON_ERROR(read_reg(handle, REG_DIRECTION, &dir_reg), TAG, "Read direction reg failed");
+    ESP_RETURN_ON_ERROR(lock(handle), TAG, "Lock failed");
+    esp_err_t ret = read_reg(handle, REG_INPUT, &input_reg);
+    if (ret == ESP_OK) {
+        ret = read_reg(handle, REG_OUTPUT, &output_reg);
+    }
+    if (ret == ESP_OK) {
+        ret = read_reg(handle, REG_DIRECTION, &dir_reg);
+    }
+    unlock(handle);
+    ESP_RETURN_ON_ERROR(ret, TAG, "Read reg failed");
     /* Get 1 if high level */
     if (handle->config.flags.input_high_bit_zero) {
         input_reg ^= 0xffffffff;
@@ -163,7 +240,96 @@ esp_err_t esp_io_expander_reset(esp_io_expander_handle_t handle)
     ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
     ESP_RETURN_ON_FALSE(handle->reset, ESP_ERR_NOT_SUPPORTED, TAG, "reset isn't implemented");
 
-    return handle->reset(handle);
+    ESP_RETURN_ON_ERROR(lock(handle), TAG, "Lock failed");
+    /* The registers are back to their default values, even if the reset failed halfway */
+    handle->cache.output_valid = 0;
+    handle->cache.direction_valid = 0;
+    handle->cache.input_valid = 0;
+    handle->stats.transactions++;
+    esp_err_t ret = handle->reset(handle);
+    unlock(handle);
+
+    return ret;
+}
+
+esp_err_t esp_io_expander_enable_interrupt(esp_io_expander_handle_t handle, int gpio_num)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+    ESP_RETURN_ON_FALSE(GPIO_IS_VALID_GPIO(gpio_num), ESP_ERR_INVALID_ARG, TAG, "Invalid GPIO");
+    ESP_RETURN_ON_FALSE(!handle->interrupt.task, ESP_ERR_INVALID_STATE, TAG, "Interrupt already enabled");
+
+    esp_err_t ret = ESP_OK;
+    handle->interrupt.stopped = xSemaphoreCreateBinary();
+    ESP_RETURN_ON_FALSE(handle->interrupt.stopped, ESP_ERR_NO_MEM, TAG, "No memory");
+    handle->interrupt.stop = false;
+    handle->interrupt.gpio_num = gpio_num;
+
+    const gpio_config_t int_gpio_config = {
+        .pin_bit_mask = BIT64(gpio_num),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_NEGEDGE,
+    };
+    ESP_GOTO_ON_ERROR(gpio_config(&int_gpio_config), err, TAG, "Config INT GPIO failed");
+    ret = gpio_install_isr_service(0);
+    /* Already installed by the application */
+    ESP_GOTO_ON_FALSE(ret == ESP_OK || ret == ESP_ERR_INVALID_STATE, ret, err, TAG, "Install GPIO ISR service failed");
+
+    /* Reading the input register releases the INT line */
+    ESP_GOTO_ON_ERROR(lock(handle), err, TAG, "Lock failed");
+    handle->cache.input_valid = 0;
+    ret = read_reg(handle, REG_INPUT, &handle->interrupt.input);
+    unlock(handle);
+    ESP_GOTO_ON_ERROR(ret, err, TAG, "Read input reg failed");
+
+    ESP_GOTO_ON_FALSE(xTaskCreate(interrupt_task, "io_expander_int", IO_EXPANDER_INTERRUPT_TASK_STACK, handle,
+                                  IO_EXPANDER_INTERRUPT_TASK_PRIORITY, &handle->interrupt.task) == pdPASS, ESP_ERR_NO_MEM, err, TAG, "Create task failed");
+    ESP_GOTO_ON_ERROR(gpio_isr_handler_add(gpio_num, interrupt_isr, handle), err, TAG, "Add INT GPIO ISR handler failed");
+    /* Catch a change between the first read and the ISR being added, the line is already low then */
+    xTaskNotifyGive(handle->interrupt.task);
+
+    return ESP_OK;
+
+err:
+    interrupt_deinit(handle);
+    return ret;
+}
+
+esp_err_t esp_io_expander_register_input_cb(esp_io_expander_handle_t handle, uint32_t pin_num_mask, esp_io_expander_edge_t edge,
+                                            esp_io_expander_input_cb_t cb, void *user_ctx)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+    ESP_RETURN_ON_FALSE(cb, ESP_ERR_INVALID_ARG, TAG, "Invalid callback");
+    if (pin_num_mask >= BIT64(VALID_IO_COUNT(handle))) {
+        ESP_LOGW(TAG, "Pin num mask out of range, bit higher than %d won't work", VALID_IO_COUNT(handle) - 1);
+    }
+
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    ESP_RETURN_ON_ERROR(lock(handle), TAG, "Lock failed");
+    for (int i = 0; i < IO_EXPANDER_INPUT_CB_MAX; i++) {
+        if (!handle->interrupt.cbs[i].cb) {
+            handle->interrupt.cbs[i].pin_num_mask = pin_num_mask;
+            handle->interrupt.cbs[i].edge = edge;
+            handle->interrupt.cbs[i].user_ctx = user_ctx;
+            handle->interrupt.cbs[i].cb = cb;
+            ret = ESP_OK;
+            break;
+        }
+    }
+    unlock(handle);
+    ESP_RETURN_ON_ERROR(ret, TAG, "Too many callbacks");
+
+    return ESP_OK;
+}
+
+esp_err_t esp_io_expander_get_stats(esp_io_expander_handle_t handle, esp_io_expander_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "Invalid stats");
+
+    *stats = handle->stats;
+    return ESP_OK;
 }
 
 esp_err_t esp_io_expander_del(esp_io_expander_handle_t handle)
@@ -171,9 +337,276 @@ esp_err_t esp_io_expander_del(esp_io_expander_handle_t handle)
     ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
     ESP_RETURN_ON_FALSE(handle->del, ESP_ERR_NOT_SUPPORTED, TAG, "del isn't implemented");
 
+    if (handle->async.task) {
+        /* Stop the worker between two writes and wait for it to exit, pending writes are dropped */
+        SemaphoreHandle_t stopped = xSemaphoreCreateBinary();
+        ESP_RETURN_ON_FALSE(stopped, ESP_ERR_NO_MEM, TAG, "No memory");
+        const async_write_t stop = {
+            .stopped = stopped,
+        };
+        xQueueReset(handle->async.queue);
+        xQueueSendToFront(handle->async.queue, &stop, portMAX_DELAY);
+        xSemaphoreTake(stopped, portMAX_DELAY);
+        vSemaphoreDelete(stopped);
+        vQueueDelete(handle->async.queue);
+        handle->async.task = NULL;
+        handle->async.queue = NULL;
+    }
+    if (handle->interrupt.stopped) {
+        interrupt_deinit(handle);
+    }
+    if (handle->lock) {
+        vSemaphoreDelete(handle->lock);
+        handle->lock = NULL;
+    }
+
     return handle->del(handle);
 }
 
+/**
+ * @brief Set the direction of a set of target IOs, the lock must be held
+ */
+static esp_err_t set_dir(esp_io_expander_handle_t handle, uint32_t pin_num_mask, esp_io_expander_dir_t direction)
+{
+    bool is_output = (direction == IO_EXPANDER_OUTPUT) ? true : false;
+    uint32_t dir_reg, temp;
+    ESP_RETURN_ON_ERROR(read_reg(handle, REG_DIRECTION, &dir_reg), TAG, "Read direction reg failed");
+    temp = dir_reg;
+    if ((is_output && !handle->config.flags.dir_out_bit_zero) || (!is_output && handle->config.flags.dir_out_bit_zero)) {
+        /* 1. Output && Set 1 to output */
+        /* 2. Input && Set 1 to input */
+        dir_reg |= pin_num_mask;
+    } else {
+        /* 3. Output && Set 0 to output */
+        /* 4. Input && Set 0 to input */
+        dir_reg &= ~pin_num_mask;
+    }
+    /* Write to reg only when different */
+    if (dir_reg != temp) {
+        ESP_RETURN_ON_ERROR(write_reg(handle, REG_DIRECTION, dir_reg), TAG, "Write direction reg failed");
+    } else {
+        handle->stats.transactions_avoided++;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Apply a sequence of output levels to a set of target IOs, the lock must be held
+ */
+static esp_err_t set_level_sequence(esp_io_expander_handle_t handle, uint32_t pin_num_mask, const uint32_t *levels, size_t count)
+{
+    ESP_RETURN_ON_ERROR(check_output_mode(handle, pin_num_mask), TAG, "Check output mode failed");
+
+    uint32_t output_reg;
+    /* Read the current output level once, the following values are computed from it */
+    ESP_RETURN_ON_ERROR(read_reg(handle, REG_OUTPUT, &output_reg), TAG, "Read Output reg failed");
+
+    uint32_t values[OUTPUT_BURST_MAX];
+    size_t values_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        /* Set 1 to output high, or 0 if the high bit is zero */
+        uint32_t level = handle->config.flags.output_high_bit_zero ? ~levels[i] : levels[i];
+        uint32_t value = (output_reg & ~pin_num_mask) | (level & pin_num_mask);
+        /* Write to reg only when different */
+        if (value == output_reg) {
+            handle->stats.transactions_avoided++;
+            continue;
+        }
+        output_reg = value;
+        values[values_count++] = value;
+        if (values_count == OUTPUT_BURST_MAX) {
+            ESP_RETURN_ON_ERROR(write_output_burst(handle, values, values_count), TAG, "Write Output reg failed");
+            values_count = 0;
+        }
+    }
+    if (values_count > 0) {
+        ESP_RETURN_ON_ERROR(write_output_burst(handle, values, values_count), TAG, "Write Output reg failed");
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Get the input level of a set of target IOs, the lock must be held
+ */
+static esp_err_t get_level(esp_io_expander_handle_t handle, uint32_t pin_num_mask, uint32_t *level_mask)
+{
+    uint32_t input_reg;
+    ESP_RETURN_ON_ERROR(read_reg(handle, REG_INPUT, &input_reg), TAG, "Read input reg failed");
+    if (!handle->config.flags.input_high_bit_zero) {
+        /* Get 1 when input high level */
+        *level_mask = input_reg & pin_num_mask;
+    } else {
+        /* Get 0 when input high level */
+        *level_mask = ~input_reg & pin_num_mask;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Set the output levels of a set of target IOs in one register write, the lock must be held
+ */
+static esp_err_t set_output(esp_io_expander_handle_t handle, uint32_t pin_num_mask, uint32_t level_mask)
+{
+    ESP_RETURN_ON_ERROR(check_output_mode(handle, pin_num_mask), TAG, "Check output mode failed");
+
+    uint32_t output_reg, temp;
+    /* Read the current output level */
+    ESP_RETURN_ON_ERROR(read_reg(handle, REG_OUTPUT, &output_reg), TAG, "Read Output reg failed");
+    temp = output_reg;
+    /* Set expected output level, 1 to output high or 0 if the high bit is zero */
+    uint32_t level = handle->config.flags.output_high_bit_zero ? ~level_mask : level_mask;
+    output_reg = (output_reg & ~pin_num_mask) | (level & pin_num_mask);
+    /* Write to reg only when different */
+    if (output_reg != temp) {
+        ESP_RETURN_ON_ERROR(write_reg(handle, REG_OUTPUT, output_reg), TAG, "Write Output reg failed");
+    } else {
+        handle->stats.transactions_avoided++;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Worker task of the asynchronous writes
+ */
+static void async_task(void *arg)
+{
+    esp_io_expander_handle_t handle = (esp_io_expander_handle_t)arg;
+    async_write_t write;
+
+    while (true) {
+        if (xQueueReceive(handle->async.queue, &write, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        if (write.stopped) {
+            xSemaphoreGive(write.stopped);
+            vTaskDelete(NULL);
+        }
+        /* Created before the task, cannot fail */
+        lock(handle);
+        esp_err_t ret = set_output(handle, write.pin_num_mask, write.level_mask);
+        unlock(handle);
+        if (write.cb) {
+            write.cb(handle, ret, write.user_ctx);
+        }
+    }
+}
+
+/**
+ * @brief Create the queue and worker task of the asynchronous writes, the lock must be held
+ */
+static esp_err_t async_init(esp_io_expander_handle_t handle)
+{
+    esp_err_t ret = ESP_OK;
+    QueueHandle_t queue = xQueueCreate(IO_EXPANDER_ASYNC_QUEUE_LEN, sizeof(async_write_t));
+    ESP_GOTO_ON_FALSE(queue, ESP_ERR_NO_MEM, err, TAG, "No memory");
+
+    handle->async.queue = queue;
+    ESP_GOTO_ON_FALSE(xTaskCreate(async_task, "io_expander", IO_EXPANDER_ASYNC_TASK_STACK, handle, IO_EXPANDER_ASYNC_TASK_PRIORITY,
+                                  &handle->async.task) == pdPASS, ESP_ERR_NO_MEM, err, TAG, "Create task failed");
+
+    return ESP_OK;
+
+err:
+    handle->async.queue = NULL;
+    handle->async.task = NULL;
+    if (queue) {
+        vQueueDelete(queue);
+    }
+    return ret;
+}
+
+/**
+ * @brief INT line handler, the register is read by the interrupt task
+ */
+static void IRAM_ATTR interrupt_isr(void *arg)
+{
+    esp_io_expander_handle_t handle = (esp_io_expander_handle_t)arg;
+    BaseType_t need_yield = pdFALSE;
+
+    vTaskNotifyGiveFromISR(handle->interrupt.task, &need_yield);
+    portYIELD_FROM_ISR(need_yield);
+}
+
+/**
+ * @brief Refresh the shadow copy of the input register and call the callbacks of the changed pins
+ */
+static void interrupt_task(void *arg)
+{
+    esp_io_expander_handle_t handle = (esp_io_expander_handle_t)arg;
+    uint32_t input_reg;
+    TickType_t wait = portMAX_DELAY;
+    bool failed = false;
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, wait);
+        if (handle->interrupt.stop) {
+            xSemaphoreGive(handle->interrupt.stopped);
+            vTaskDelete(NULL);
+        }
+
+        /* Created before the task, cannot fail */
+        lock(handle);
+        handle->cache.input_valid = 0;
+        esp_err_t ret = read_reg(handle, REG_INPUT, &input_reg);
+        uint32_t changed = input_reg ^ handle->interrupt.input;
+        if (ret == ESP_OK) {
+            handle->interrupt.input = input_reg;
+        }
+        /* Copy the callbacks, they are called without the lock so they can access the device */
+        esp_io_expander_input_watch_t cbs[IO_EXPANDER_INPUT_CB_MAX];
+        memcpy(cbs, handle->interrupt.cbs, sizeof(cbs));
+        unlock(handle);
+        /* The line stays low until the register is read, no falling edge comes then: poll until it is released */
+        wait = (ret != ESP_OK || !gpio_get_level(handle->interrupt.gpio_num)) ? pdMS_TO_TICKS(IO_EXPANDER_INTERRUPT_POLL_MS) : portMAX_DELAY;
+        if (ret != ESP_OK) {
+            if (!failed) {
+                ESP_LOGE(TAG, "Read input reg failed, polling");
+            }
+            failed = true;
+            continue;
+        }
+        failed = false;
+        if (!changed) {
+            continue;
+        }
+
+        uint32_t level = handle->config.flags.input_high_bit_zero ? ~input_reg : input_reg;
+        uint32_t rising = changed & level;
+        uint32_t falling = changed & ~level;
+        for (int i = 0; i < IO_EXPANDER_INPUT_CB_MAX; i++) {
+            if (!cbs[i].cb) {
+                continue;
+            }
+            uint32_t pins = ((cbs[i].edge & IO_EXPANDER_EDGE_RISING) ? rising : 0) | ((cbs[i].edge & IO_EXPANDER_EDGE_FALLING) ? falling : 0);
+            pins &= cbs[i].pin_num_mask;
+            if (pins) {
+                cbs[i].cb(handle, pins, level & cbs[i].pin_num_mask, cbs[i].user_ctx);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Stop the interrupt task between two reads, wait for it to exit and release the INT GPIO
+ */
+static void interrupt_deinit(esp_io_expander_handle_t handle)
+{
+    if (handle->interrupt.task) {
+        gpio_isr_handler_remove(handle->interrupt.gpio_num);
+        handle->interrupt.stop = true;
+        xTaskNotifyGive(handle->interrupt.task);
+        xSemaphoreTake(handle->interrupt.stopped, portMAX_DELAY);
+        handle->interrupt.task = NULL;
+    }
+    gpio_reset_pin(handle->interrupt.gpio_num);
+    vSemaphoreDelete(handle->interrupt.stopped);
+    handle->interrupt.stopped = NULL;
+}
+
 /**
  * @brief Write the value to a specific register
  *
@@ -185,13 +618,26 @@ esp_err_t esp_io_expander_del(esp_io_expander_handle_t handle)
  */
 static esp_err_t write_reg(esp_io_expander_handle_t handle, reg_type_t reg, uint32_t value)
 {
+    esp_err_t ret;
     switch (reg) {
     case REG_OUTPUT:
         ESP_RETURN_ON_FALSE(handle->write_output_reg, ESP_ERR_NOT_SUPPORTED, TAG, "write_output_reg isn't implemented");
-        return handle->write_output_reg(handle, value);
+        handle->stats.transactions++;
+        ret = handle->write_output_reg(handle, value);
+        /* A failed write leaves the register unknown */
+        handle->cache.output = value;
+        handle->cache.output_valid = (ret == ESP_OK);
+        /* The input register follows the output pins without asserting the INT line */
+        handle->cache.input_valid = 0;
+        return ret;
     case REG_DIRECTION:
         ESP_RETURN_ON_FALSE(handle->write_direction_reg, ESP_ERR_NOT_SUPPORTED, TAG, "write_direction_reg isn't implemented");
-        return handle->write_direction_reg(handle, value);
+        handle->stats.transactions++;
+        ret = handle->write_direction_reg(handle, value);
+        handle->cache.direction = value;
+        handle->cache.direction_valid = (ret == ESP_OK);
+        handle->cache.input_valid = 0;
+        return ret;
     default:
         return ESP_ERR_NOT_SUPPORTED;
     }
@@ -212,16 +658,46 @@ static esp_err_t read_reg(esp_io_expander_handle_t handle, reg_type_t reg, uint3
 {
     ESP_RETURN_ON_FALSE(value, ESP_ERR_INVALID_ARG, TAG, "Invalid value");
 
+    esp_err_t ret;
     switch (reg) {
     case REG_INPUT:
+        /* Coherent while the interrupt task refreshes it on every change */
+        if (handle->cache.input_valid) {
+            handle->stats.transactions_avoided++;
+            *value = handle->cache.input;
+            return ESP_OK;
+        }
         ESP_RETURN_ON_FALSE(handle->read_input_reg, ESP_ERR_NOT_SUPPORTED, TAG, "read_input_reg isn't implemented");
-        return handle->read_input_reg(handle, value);
+        handle->stats.transactions++;
+        ret = handle->read_input_reg(handle, value);
+        handle->cache.input = *value;
+        handle->cache.input_valid = (ret == ESP_OK) && handle->interrupt.task;
+        return ret;
     case REG_OUTPUT:
+        /* Serve from the shadow copy when coherent */
+        if (handle->cache.output_valid) {
+            handle->stats.transactions_avoided++;
+            *value = handle->cache.output;
+            return ESP_OK;
+        }
         ESP_RETURN_ON_FALSE(handle->read_output_reg, ESP_ERR_NOT_SUPPORTED, TAG, "read_output_reg isn't implemented");
-        return handle->read_output_reg(handle, value);
+        handle->stats.transactions++;
+        ret = handle->read_output_reg(handle, value);
+        handle->cache.output = *value;
+        handle->cache.output_valid = (ret == ESP_OK);
+        return ret;
     case REG_DIRECTION:
+        if (handle->cache.direction_valid) {
+            handle->stats.transactions_avoided++;
+            *value = handle->cache.direction;
+            return ESP_OK;
+        }
         ESP_RETURN_ON_FALSE(handle->read_direction_reg, ESP_ERR_NOT_SUPPORTED, TAG, "read_direction_reg isn't implemented");
-        return handle->read_direction_reg(handle, value);
+        handle->stats.transactions++;
+        ret = handle->read_direction_reg(handle, value);
+        handle->cache.direction = *value;
+        handle->cache.direction_valid = (ret == ESP_OK);
+        return ret;
     default:
         return ESP_ERR_NOT_SUPPORTED;
     }
@@ -229,5 +705,62 @@ static esp_err_t read_reg(esp_io_expander_handle_t handle, reg_type_t reg, uint3
     return ESP_OK;
 }
 
+/**
+ * @brief Check that a set of target IOs are in output mode
+ *
+ * @param handle: IO Expander handle
+ * @param pin_num_mask: Bitwise OR of allowed pin num with type of `esp_io_expander_pin_num_t`
+ * @return
+ *      - ESP_OK: Success, ESP_ERR_INVALID_STATE if a target IO is in input mode, otherwise returns ESP_ERR_xxx
+ */
+static esp_err_t check_output_mode(esp_io_expander_handle_t handle, uint32_t pin_num_mask)
+{
+    uint32_t dir_reg, dir_bit;
+    ESP_RETURN_ON_ERROR(read_reg(handle, REG_DIRECTION, &dir_reg), TAG, "Read direction reg failed");
+
+    uint8_t io_count = VALID_IO_COUNT(handle);
+    /* Check every target pin's direction, must be in output mode */
+    for (int i = 0; i < io_count; i++) {
+        if (pin_num_mask & BIT(i)) {
+            dir_bit = dir_reg & BIT(i);
+            /* Check whether it is in input mode */
+            if ((dir_bit && handle->config.flags.dir_out_bit_zero) || (!dir_bit && !handle->config.flags.dir_out_bit_zero)) {
+                /* 1. 1 && Set 1 to input */
+                /* 2. 0 && Set 0 to input */
+                ESP_LOGE(TAG, "Pin[%d] can't set level in input mode", i);
+                return ESP_ERR_INVALID_STATE;
+            }
+        }
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Write several values to the output register, in one burst if supported by the device
+ *
+ * @param handle: IO Expander handle
+ * @param values: Output register's values, applied in order
+ * @param count: Number of values
+ * @return
+ *      - ESP_OK: Success, otherwise returns ESP_ERR_xxx
+ */
+static esp_err_t write_output_burst(esp_io_expander_handle_t handle, const uint32_t *values, size_t count)
+{
+    if (handle->write_output_reg_burst) {
+        handle->stats.transactions++;
+        esp_err_t ret = handle->write_output_reg_burst(handle, values, count);
+        handle->cache.output = values[count - 1];
+        handle->cache.output_valid = (ret == ESP_OK);
+        handle->cache.input_valid = 0;
+        return ret;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        ESP_RETURN_ON_ERROR(write_reg(handle, REG_OUTPUT, values[i]), TAG, "Write Output reg failed");
+    }
+
+    return ESP_OK;
+}
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,237 @@
+#include <esp_lcd.h>
+#include <esp32-hal-log.h>
+#include <esp_timer.h>
+#include <esp_rom_sys.h>
+#include <esp_attr.h>
+#include <esp_lcd_panel_commands.h>
+
+static int64_t lcd_boot_profile_us[LCD_BOOT_PHASE_MAX];
+
+// Tearing effect, updated from the GPIO ISR
+static struct
+{
+    SemaphoreHandle_t vblank;
+    portMUX_TYPE lock;
+    volatile uint32_t frame_count;
+    volatile int64_t last_vblank_us;
+    volatile uint32_t period_us;
+    uint8_t long_periods;
+} lcd_te = {.lock = portMUX_INITIALIZER_UNLOCKED};
+
+esp_err_t lcd_tx_init_bytecode(esp_lcd_panel_io_handle_t io, const uint8_t *bytecode, size_t size)
+{
+    log_v("io:0x%08x, bytecode:0x%08x, size:%d", io, bytecode, size);
+    if (io == NULL || (bytecode == NULL && size > 0))
+        return ESP_ERR_INVALID_ARG;
+
+    esp_err_t res;
+    const uint8_t *end = bytecode + size;
+    while (bytecode < end)
+    {
+        if (end - bytecode < 2)
+        {
+            log_e("Init bytecode truncated");
+            return ESP_ERR_INVALID_SIZE;
+        }
+
+        uint8_t cmd = *bytecode++;
+        uint8_t bytes = *bytecode & ~LCD_INIT_DELAY;
+        bool delay = (*bytecode++ & LCD_INIT_DELAY) != 0;
+        if (end - bytecode < bytes + delay)
+        {
+            log_e("Init bytecode truncated at command: 0x%02x", cmd);
+            return ESP_ERR_INVALID_SIZE;
+        }
+
+        if ((res = esp_lcd_panel_io_tx_param(io, cmd, bytes > 0 ? bytecode : NULL, bytes)) != ESP_OK)
+        {
+            log_e("Sending command: 0x%02x failed", cmd);
+            return res;
+        }
+
+        bytecode += bytes;
+        if (delay)
+        {
+            uint8_t delay_ms = *bytecode++;
+            if (delay_ms > 0)
+                vTaskDelay(pdMS_TO_TICKS(delay_ms));
+        }
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t lcd_tx_init_cmds(esp_lcd_panel_io_handle_t io, const lcd_init_cmd_t *cmds, size_t count)
+{
+    log_v("io:0x%08x, cmds:0x%08x, count:%d", io, cmds, count);
+    if (io == NULL || (cmds == NULL && count > 0))
+        return ESP_ERR_INVALID_ARG;
+
+    esp_err_t res;
+    while (count-- > 0)
+    {
+        if ((res = esp_lcd_panel_io_tx_param(io, cmds->cmd, cmds->data, cmds->bytes)) != ESP_OK)
+        {
+            log_e("Sending command: 0x%02x failed", cmds->cmd);
+            return res;
+        }
+
+        // Only yield when the controller needs the time
+        if (cmds->delay_ms > 0)
+            vTaskDelay(pdMS_TO_TICKS(cmds->delay_ms));
+
+        cmds++;
+    }
+
+    return ESP_OK;
+}
+
+void lcd_wait_until(int64_t deadline_us)
+{
+    int64_t remaining_us;
+    while ((remaining_us = deadline_us - esp_timer_get_time()) > 0)
+    {
+        // vTaskDelay can return up to one tick early, busy wait the last tick
+        TickType_t ticks = remaining_us / (1000 * portTICK_PERIOD_MS);
+        if (ticks > 1)
+            vTaskDelay(ticks - 1);
+        else
+            esp_rom_delay_us(remaining_us);
+    }
+}
+
+void lcd_boot_profile_add(lcd_boot_phase_t phase, int64_t start_us)
+{
+    if (phase < LCD_BOOT_PHASE_MAX)
+        lcd_boot_profile_us[phase] += esp_timer_get_time() - start_us;
+}
+
+void lcd_boot_profile_log(void)
+{
+    log_d("LCD boot: reset %d us, SLPOUT wait %d us, init table %d us, DISPON %d us, display on at %d ms since boot",
+          (int32_t)lcd_boot_profile_us[LCD_BOOT_PHASE_RESET],
+          (int32_t)lcd_boot_profile_us[LCD_BOOT_PHASE_SLPOUT_WAIT],
+          (int32_t)lcd_boot_profile_us[LCD_BOOT_PHASE_INIT_TABLE],
+          (int32_t)lcd_boot_profile_us[LCD_BOOT_PHASE_DISPON],
+          (int32_t)(esp_timer_get_time() / 1000));
+}
+
+static void IRAM_ATTR lcd_te_isr(void *arg)
+{
+    int64_t now_us = esp_timer_get_time();
+    portENTER_CRITICAL_ISR(&lcd_te.lock);
+    // Running average of the refresh period. A single long period is a missed edge, a few in a row a new frame rate
+    uint32_t period_us = now_us - lcd_te.last_vblank_us;
+    if (lcd_te.frame_count > 0)
+    {
+        if (lcd_te.period_us == 0 || lcd_te.long_periods >= 4)
+        {
+            lcd_te.period_us = period_us;
+            lcd_te.long_periods = 0;
+        }
+        else if (period_us > lcd_te.period_us * 3 / 2)
+            lcd_te.long_periods++;
+        else
+        {
+            lcd_te.period_us = (lcd_te.period_us * 7 + period_us) / 8;
+            lcd_te.long_periods = 0;
+        }
+    }
+
+    lcd_te.last_vblank_us = now_us;
+    lcd_te.frame_count++;
+    portEXIT_CRITICAL_ISR(&lcd_te.lock);
+
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    xSemaphoreGiveFromISR(lcd_te.vblank, &higher_priority_task_woken);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+esp_err_t lcd_te_enable(esp_lcd_panel_io_handle_t io, gpio_num_t te_gpio)
+{
+    log_v("io:0x%08x, te_gpio:%d", io, te_gpio);
+    if (io == NULL || !GPIO_IS_VALID_GPIO(te_gpio))
+        return ESP_ERR_INVALID_ARG;
+
+    if (lcd_te.vblank != NULL)
+    {
+        log_w("TE already enabled");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t res;
+    const gpio_config_t cfg = {
+        .pin_bit_mask = BIT64(te_gpio),
+        .mode = GPIO_MODE_INPUT,
+        .intr_type = GPIO_INTR_POSEDGE};
+    if ((res = gpio_config(&cfg)) != ESP_OK)
+    {
+        log_e("Configuring GPIO for TE failed");
+        return res;
+    }
+
+    // The ISR service can already be installed by the touch driver or the application
+    if ((res = gpio_install_isr_service(0)) != ESP_OK && res != ESP_ERR_INVALID_STATE)
+    {
+        log_e("Installing the GPIO ISR service failed");
+        return res;
+    }
+
+    // TE output on V-blank only
+    const uint8_t te_mode = 0x00;
+    if ((res = esp_lcd_panel_io_tx_param(io, LCD_CMD_TEON, &te_mode, 1)) != ESP_OK)
+    {
+        log_e("Sending TEON failed");
+        return res;
+    }
+
+    if ((lcd_te.vblank = xSemaphoreCreateBinary()) == NULL)
+    {
+        log_e("No memory available for the TE semaphore");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if ((res = gpio_isr_handler_add(te_gpio, lcd_te_isr, NULL)) != ESP_OK)
+    {
+        log_e("Adding the TE ISR failed");
+        vSemaphoreDelete(lcd_te.vblank);
+        lcd_te.vblank = NULL;
+        return res;
+    }
+
+    log_d("TE enabled on GPIO %d", te_gpio);
+    return ESP_OK;
+}
+
+bool lcd_te_enabled(void)
+{
+    return lcd_te.vblank != NULL;
+}
+
+esp_err_t lcd_te_wait_vblank(uint32_t timeout_ms)
+{
+    if (lcd_te.vblank == NULL)
+        return ESP_ERR_INVALID_STATE;
+
+    // Discard an edge that happened before the call
+    xSemaphoreTake(lcd_te.vblank, 0);
+    return xSemaphoreTake(lcd_te.vblank, pdMS_TO_TICKS(timeout_ms)) == pdTRUE ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t lcd_te_get_info(lcd_te_info_t *info)
+{
+    if (info == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    if (lcd_te.vblank == NULL)
+        return ESP_ERR_INVALID_STATE;
+
+    portENTER_CRITICAL(&lcd_te.lock);
+    *info = (lcd_te_info_t){
+        .frame_count = lcd_te.frame_count,
+        .last_vblank_us = lcd_te.last_vblank_us,
+        .period_us = lcd_te.period_us};
+    portEXIT_CRITICAL(&lcd_te.lock);
+
+    return ESP_OK;
+}
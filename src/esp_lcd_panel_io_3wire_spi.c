@@ -10,6 +10,9 @@
 
 #include "driver/gpio.h"
 #include "driver/spi_master.h"
+#include "soc/gpio_struct.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_check.h"
@@ -26,6 +29,27 @@
 #define WRITE_ORDER_LSB_MASK    (0x01)  // Bit mask for LSB first write order
 #define WRITE_ORDER_MSB_MASK    (0x80)  // Bit mask for MSB first write order
 
+// When all lines are GPIOs the packages are sent by the SPI peripheral instead of bit-banged
+#ifndef PANEL_IO_3WIRE_SPI_USE_HW
+#define PANEL_IO_3WIRE_SPI_USE_HW       (1)
+#endif
+#ifndef PANEL_IO_3WIRE_SPI_HOST
+#define PANEL_IO_3WIRE_SPI_HOST         (SPI2_HOST)
+#endif
+#ifndef PANEL_IO_3WIRE_SPI_HW_CLK
+#define PANEL_IO_3WIRE_SPI_HW_CLK       (4 * 1000 * 1000UL)
+#endif
+#define HW_TRANS_BYTES_MAX      (32)    // Packages sent by the SPI peripheral in one transaction
+// When bit-banging GPIOs, write the GPIO output registers directly and time the edges with the CPU cycle counter
+#ifndef PANEL_IO_3WIRE_SPI_FAST_GPIO
+#define PANEL_IO_3WIRE_SPI_FAST_GPIO    (1)
+#endif
+// When all lines are on the IO expander, the waveform of a package is computed first and written as a sequence of output levels
+#ifndef PANEL_IO_3WIRE_SPI_EXPANDER_BATCH
+#define PANEL_IO_3WIRE_SPI_EXPANDER_BATCH   (1)
+#endif
+#define EXPANDER_STEPS_MAX      (4 + 2 * (1 + LCD_CMD_BYTES_MAX * 8))   // Output levels of the largest package
+
 /**
  * @brief Enumeration of SPI lines
  */
@@ -48,7 +72,15 @@ typedef struct {
     panel_io_type_t sda_io_type;            /*!< IO type of SDA line */
     int sda_io_num;                         /*!< GPIO used for SDA line */
     esp_io_expander_handle_t io_expander;   /*!< IO expander handle, set to NULL if not used */
+    spi_device_handle_t spi_dev;            /*!< SPI device when the packages are sent by the SPI peripheral, NULL if bit-banged */
+    uint32_t clk_speed;                     /*!< SCL frequency when bit-banged */
     uint32_t scl_half_period_us;            /*!< SCL half period in us */
+    uint32_t scl_half_period_cycles;        /*!< SCL half period in CPU cycles, for the fast GPIO path */
+    struct {
+        volatile uint32_t *set_reg;         /*!< Write 1 to set register of the GPIO bank */
+        volatile uint32_t *clr_reg;         /*!< Write 1 to clear register of the GPIO bank */
+        uint32_t mask;                      /*!< Bit of the GPIO in the bank */
+    } fast_line[3];                         /*!< Output registers of the lines, indexed by `spi_line_t` */
     uint32_t lcd_cmd_bytes: 3;              /*!< Bytes of LCD command (1 ~ 4) */
     uint32_t cmd_dc_bit: 2;                 /*!< DC bit of command */
     uint32_t lcd_param_bytes: 3;            /*!< Bytes of LCD parameter (1 ~ 4) */
@@ -59,6 +91,8 @@ typedef struct {
         uint32_t sda_scl_idle_high: 1;      /*!< If this flag is enabled, SDA and SCL line are high when idle */
         uint32_t scl_active_rising_edge: 1; /*!< If this flag is enabled, SCL line is active on rising edge */
         uint32_t del_keep_cs_inactive: 1;   /*!< If this flag is enabled, keep CS line inactive even if panel_io is deleted */
+        uint32_t fast_gpio: 1;              /*!< If this flag is enabled, all lines are GPIOs driven through the output registers */
+        uint32_t expander_batch: 1;         /*!< If this flag is enabled, all lines are on the IO expander and a package is written as one sequence */
     } flags;
 } esp_lcd_panel_io_3wire_spi_t;
 
@@ -72,7 +106,19 @@ static esp_err_t panel_io_register_event_callbacks(esp_lcd_panel_io_handle_t io,
 
 static esp_err_t set_line_level(esp_lcd_panel_io_3wire_spi_t *panel_io, spi_line_t line, uint32_t level);
 static esp_err_t reset_line_io(esp_lcd_panel_io_3wire_spi_t *panel_io, spi_line_t line);
+static esp_err_t bitbang_init(esp_lcd_panel_io_3wire_spi_t *panel_io);
 static esp_err_t spi_write_package(esp_lcd_panel_io_3wire_spi_t *panel_io, bool is_cmd, uint32_t data);
+#if PANEL_IO_3WIRE_SPI_EXPANDER_BATCH
+static esp_err_t expander_write_package(esp_lcd_panel_io_3wire_spi_t *panel_io, bool is_cmd, uint32_t data);
+#endif
+#if PANEL_IO_3WIRE_SPI_FAST_GPIO
+static void fast_gpio_init(esp_lcd_panel_io_3wire_spi_t *panel_io, uint32_t clk_speed);
+static esp_err_t fast_gpio_write_package(esp_lcd_panel_io_3wire_spi_t *panel_io, bool is_cmd, uint32_t data);
+#endif
+#if PANEL_IO_3WIRE_SPI_USE_HW
+static esp_err_t hw_spi_init(esp_lcd_panel_io_3wire_spi_t *panel_io);
+#endif
+static esp_err_t hw_spi_tx_param(esp_lcd_panel_io_3wire_spi_t *panel_io, int lcd_cmd, const void *param, size_t param_size);
 
 esp_err_t esp_lcd_new_panel_io_3wire_spi(const esp_lcd_panel_io_3wire_spi_config_t *io_config, esp_lcd_panel_io_handle_t *ret_io)
 {
@@ -98,8 +144,8 @@ esp_err_t esp_lcd_new_panel_io_3wire_spi(const esp_lcd_panel_io_3wire_spi_config
     panel_io->sda_io_type = line_config->sda_io_type;
     panel_io->sda_io_num = line_config->sda_gpio_num;
     panel_io->io_expander = line_config->io_expander;
-    uint32_t expect_clk_speed = io_config->expect_clk_speed ? io_config->expect_clk_speed : PANEL_IO_3WIRE_SPI_CLK_MAX;
-    panel_io->scl_half_period_us = 1000000 / (expect_clk_speed * 2);
+    panel_io->clk_speed = io_config->expect_clk_speed ? io_config->expect_clk_speed : PANEL_IO_3WIRE_SPI_CLK_MAX;
+    panel_io->scl_half_period_us = 1000000 / (panel_io->clk_speed * 2);
     panel_io->lcd_cmd_bytes = io_config->lcd_cmd_bytes;
     panel_io->lcd_param_bytes = io_config->lcd_param_bytes;
     if (io_config->flags.use_dc_bit) {
@@ -125,6 +171,61 @@ esp_err_t esp_lcd_new_panel_io_3wire_spi(const esp_lcd_panel_io_3wire_spi_config
     panel_io->base.del = panel_io_del;
     panel_io->base.register_event_callbacks = panel_io_register_event_callbacks;
 
+#if PANEL_IO_3WIRE_SPI_USE_HW
+    // The SPI peripheral can only drive GPIOs, lines on an IO expander are bit-banged
+    if (panel_io->cs_io_type == IO_TYPE_GPIO && panel_io->scl_io_type == IO_TYPE_GPIO && panel_io->sda_io_type == IO_TYPE_GPIO) {
+        if (hw_spi_init(panel_io) == ESP_OK) {
+            *ret_io = (esp_lcd_panel_io_handle_t)panel_io;
+            // Compare the init table time of the LCD boot profile with PANEL_IO_3WIRE_SPI_USE_HW set to 0
+            ESP_LOGI(TAG, "Panel IO create success (SPI peripheral, %lu Hz), version: %d.%d.%d", PANEL_IO_3WIRE_SPI_HW_CLK,
+                     ESP_LCD_PANEL_IO_ADDITIONS_VER_MAJOR, ESP_LCD_PANEL_IO_ADDITIONS_VER_MINOR, ESP_LCD_PANEL_IO_ADDITIONS_VER_PATCH);
+            return ESP_OK;
+        }
+        ESP_LOGW(TAG, "SPI peripheral not available, bit-banging the lines");
+    }
+#endif
+
+    esp_err_t ret = bitbang_init(panel_io);
+    if (ret != ESP_OK) {
+        free(panel_io);
+        return ret;
+    }
+
+    *ret_io = (esp_lcd_panel_io_handle_t)panel_io;
+    ESP_LOGI(TAG, "Panel IO create success (bit-bang, %lu Hz), version: %d.%d.%d", panel_io->clk_speed, ESP_LCD_PANEL_IO_ADDITIONS_VER_MAJOR,
+             ESP_LCD_PANEL_IO_ADDITIONS_VER_MINOR, ESP_LCD_PANEL_IO_ADDITIONS_VER_PATCH);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_3wire_spi_release_bus(esp_lcd_panel_io_handle_t io)
+{
+    ESP_RETURN_ON_FALSE(io, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    esp_lcd_panel_io_3wire_spi_t *panel_io = __containerof(io, esp_lcd_panel_io_3wire_spi_t, base);
+
+    if (!panel_io->spi_dev) {
+        return ESP_OK;
+    }
+
+    ESP_RETURN_ON_ERROR(spi_bus_remove_device(panel_io->spi_dev), TAG, "Remove SPI device failed");
+    panel_io->spi_dev = NULL;
+    ESP_RETURN_ON_ERROR(spi_bus_free(PANEL_IO_3WIRE_SPI_HOST), TAG, "Free SPI bus failed");
+    ESP_RETURN_ON_ERROR(bitbang_init(panel_io), TAG, "Bit-bang init failed");
+    ESP_LOGI(TAG, "SPI peripheral released, bit-banging the lines (%lu Hz)", panel_io->clk_speed);
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Configure the lines to be bit-banged and set them to their idle levels
+ *
+ * @param[in] panel_io Pointer to panel IO instance
+ *
+ * @return
+ *      - ESP_OK:              Success
+ *      - Others:              Fail, the lines are reset
+ */
+static esp_err_t bitbang_init(esp_lcd_panel_io_3wire_spi_t *panel_io)
+{
     // Get GPIO mask and IO expander pin mask
     esp_err_t ret = ESP_OK;
     int64_t gpio_mask = 0;
@@ -167,9 +268,15 @@ esp_err_t esp_lcd_new_panel_io_3wire_spi(const esp_lcd_panel_io_3wire_spi_config
     ESP_GOTO_ON_ERROR(set_line_level(panel_io, SCL, sda_scl_idle_level), err, TAG, "Set SCL level failed");
     ESP_GOTO_ON_ERROR(set_line_level(panel_io, SDA, sda_scl_idle_level), err, TAG, "Set SDA level failed");
 
-    *ret_io = (esp_lcd_panel_io_handle_t)panel_io;
-    ESP_LOGI(TAG, "Panel IO create success, version: %d.%d.%d", ESP_LCD_PANEL_IO_ADDITIONS_VER_MAJOR,
-             ESP_LCD_PANEL_IO_ADDITIONS_VER_MINOR, ESP_LCD_PANEL_IO_ADDITIONS_VER_PATCH);
+#if PANEL_IO_3WIRE_SPI_FAST_GPIO
+    if (!expander_pin_mask) {
+        fast_gpio_init(panel_io, panel_io->clk_speed);
+    }
+#endif
+#if PANEL_IO_3WIRE_SPI_EXPANDER_BATCH
+    panel_io->flags.expander_batch = !gpio_mask;
+#endif
+
     return ESP_OK;
 
 err:
@@ -183,7 +290,6 @@ err:
     if (expander_pin_mask) {
         esp_io_expander_set_dir(panel_io->io_expander, expander_pin_mask, IO_EXPANDER_INPUT);
     }
-    free(panel_io);
     return ret;
 }
 
@@ -191,6 +297,10 @@ static esp_err_t panel_io_tx_param(esp_lcd_panel_io_t *io, int lcd_cmd, const vo
 {
     esp_lcd_panel_io_3wire_spi_t *panel_io = __containerof(io, esp_lcd_panel_io_3wire_spi_t, base);
 
+    if (panel_io->spi_dev) {
+        return hw_spi_tx_param(panel_io, lcd_cmd, param, param_size);
+    }
+
     // Send command
     if (lcd_cmd >= 0) {
         ESP_RETURN_ON_ERROR(spi_write_package(panel_io, true, lcd_cmd), TAG, "SPI write package failed");
@@ -219,6 +329,18 @@ static esp_err_t panel_io_del(esp_lcd_panel_io_t *io)
 {
     esp_lcd_panel_io_3wire_spi_t *panel_io = __containerof(io, esp_lcd_panel_io_3wire_spi_t, base);
 
+    if (panel_io->spi_dev) {
+        ESP_RETURN_ON_ERROR(spi_bus_remove_device(panel_io->spi_dev), TAG, "Remove SPI device failed");
+        ESP_RETURN_ON_ERROR(spi_bus_free(PANEL_IO_3WIRE_SPI_HOST), TAG, "Free SPI bus failed");
+        panel_io->spi_dev = NULL;
+        if (panel_io->flags.del_keep_cs_inactive) {
+            // Take the CS line back from the SPI peripheral
+            gpio_reset_pin(panel_io->cs_io_num);
+            gpio_set_direction(panel_io->cs_io_num, GPIO_MODE_OUTPUT);
+            gpio_set_level(panel_io->cs_io_num, panel_io->flags.cs_high_active ? 0 : 1);
+        }
+    }
+
     if (!panel_io->flags.del_keep_cs_inactive) {
         ESP_RETURN_ON_ERROR(reset_line_io(panel_io, CS), TAG, "Reset CS line failed");
     } else {
@@ -416,6 +538,17 @@ static esp_err_t spi_write_byte(esp_lcd_panel_io_3wire_spi_t *panel_io, int dc_b
  */
 static esp_err_t spi_write_package(esp_lcd_panel_io_3wire_spi_t *panel_io, bool is_cmd, uint32_t data)
 {
+#if PANEL_IO_3WIRE_SPI_FAST_GPIO
+    if (panel_io->flags.fast_gpio) {
+        return fast_gpio_write_package(panel_io, is_cmd, data);
+    }
+#endif
+#if PANEL_IO_3WIRE_SPI_EXPANDER_BATCH
+    if (panel_io->flags.expander_batch) {
+        return expander_write_package(panel_io, is_cmd, data);
+    }
+#endif
+
     uint32_t data_bytes = is_cmd ? panel_io->lcd_cmd_bytes : panel_io->lcd_param_bytes;
     uint32_t cs_idle_level = panel_io->flags.cs_high_active ? 0 : 1;
     uint32_t sda_scl_idle_level = panel_io->flags.sda_scl_idle_high ? 1 : 0;
@@ -449,4 +582,325 @@ static esp_err_t spi_write_package(esp_lcd_panel_io_3wire_spi_t *panel_io, bool
     return ESP_OK;
 }
 
+#if PANEL_IO_3WIRE_SPI_FAST_GPIO
+/**
+ * @brief Precompute the output registers of the lines and the SCL half period in CPU cycles
+ *
+ * @param[in] panel_io  Pointer to panel IO instance, all lines must be GPIOs
+ * @param[in] clk_speed SCL frequency in Hz
+ */
+static void fast_gpio_init(esp_lcd_panel_io_3wire_spi_t *panel_io, uint32_t clk_speed)
+{
+    const int line_io[] = {[CS] = panel_io->cs_io_num, [SCL] = panel_io->scl_io_num, [SDA] = panel_io->sda_io_num};
+    for (int i = 0; i < sizeof(line_io) / sizeof(line_io[0]); i++) {
+        if (line_io[i] < 32) {
+            panel_io->fast_line[i].set_reg = &GPIO.out_w1ts;
+            panel_io->fast_line[i].clr_reg = &GPIO.out_w1tc;
+            panel_io->fast_line[i].mask = BIT(line_io[i]);
+        } else {
+            panel_io->fast_line[i].set_reg = &GPIO.out1_w1ts.val;
+            panel_io->fast_line[i].clr_reg = &GPIO.out1_w1tc.val;
+            panel_io->fast_line[i].mask = BIT(line_io[i] - 32);
+        }
+    }
+
+    panel_io->scl_half_period_cycles = (uint64_t)esp_rom_get_cpu_ticks_per_us() * 1000000 / (clk_speed * 2);
+    panel_io->flags.fast_gpio = 1;
+}
+
+/**
+ * @brief Set the level of a line through the GPIO output registers
+ */
+static inline void fast_gpio_set_line(esp_lcd_panel_io_3wire_spi_t *panel_io, spi_line_t line, uint32_t level)
+{
+    if (level) {
+        *panel_io->fast_line[line].set_reg = panel_io->fast_line[line].mask;
+    } else {
+        *panel_io->fast_line[line].clr_reg = panel_io->fast_line[line].mask;
+    }
+}
+
+/**
+ * @brief Wait until `cycles` after the previous deadline, the delays of the line writes are absorbed
+ */
+static inline void fast_gpio_wait(uint32_t *deadline, uint32_t cycles)
+{
+    *deadline += cycles;
+    while ((int32_t)(esp_cpu_get_cycle_count() - *deadline) < 0) {
+    }
+}
+
+/**
+ * @brief Write a package of data to LCD panel in big-endian order, same waveform as `spi_write_package()`
+ *
+ * @param[in] panel_io Pointer to panel IO instance
+ * @param[in] is_cmd   True for command, false for data
+ * @param[in] data     Data to write
+ *
+ * @return
+ *      - ESP_OK:              Success
+ */
+static esp_err_t fast_gpio_write_package(esp_lcd_panel_io_3wire_spi_t *panel_io, bool is_cmd, uint32_t data)
+{
+    uint32_t data_bytes = is_cmd ? panel_io->lcd_cmd_bytes : panel_io->lcd_param_bytes;
+    uint32_t cs_idle_level = panel_io->flags.cs_high_active ? 0 : 1;
+    uint32_t sda_scl_idle_level = panel_io->flags.sda_scl_idle_high ? 1 : 0;
+    uint32_t scl_active_befor_level = panel_io->flags.scl_active_rising_edge ? 0 : 1;
+    uint32_t scl_active_after_level = !scl_active_befor_level;
+    uint32_t half_period = panel_io->scl_half_period_cycles;
+    uint16_t write_order_mask = panel_io->write_order_mask;
+    // Swap command bytes order due to different endianness
+    uint32_t swap_data = SPI_SWAP_DATA_TX(data, data_bytes * 8);
+    int data_dc_bit = is_cmd ? panel_io->cmd_dc_bit : panel_io->param_dc_bit;
+    uint32_t deadline = esp_cpu_get_cycle_count();
+
+    // CS active
+    fast_gpio_set_line(panel_io, CS, !cs_idle_level);
+    fast_gpio_wait(&deadline, half_period);
+    fast_gpio_set_line(panel_io, SCL, scl_active_befor_level);
+    // Send data byte by byte, the DC bit before the first byte only
+    for (int i = 0; i < data_bytes; i++) {
+        uint16_t data_temp = swap_data & 0xff;
+        uint8_t data_bits = (i == 0 && data_dc_bit != DATA_NO_DC_BIT) ? 9 : 8;
+        for (uint8_t j = 0; j < data_bits; j++) {
+            if (data_bits == 9 && j == 0) {
+                fast_gpio_set_line(panel_io, SDA, data_dc_bit);
+            } else {
+                fast_gpio_set_line(panel_io, SDA, data_temp & write_order_mask);
+                data_temp = (write_order_mask == WRITE_ORDER_LSB_MASK) ? data_temp >> 1 : data_temp << 1;
+            }
+            // Generate SCL active edge
+            fast_gpio_set_line(panel_io, SCL, scl_active_befor_level);
+            fast_gpio_wait(&deadline, half_period);
+            fast_gpio_set_line(panel_io, SCL, scl_active_after_level);
+            fast_gpio_wait(&deadline, half_period);
+        }
+        swap_data >>= 8;
+    }
+    fast_gpio_set_line(panel_io, SCL, sda_scl_idle_level);
+    fast_gpio_set_line(panel_io, SDA, sda_scl_idle_level);
+    fast_gpio_wait(&deadline, half_period);
+    // CS inactive
+    fast_gpio_set_line(panel_io, CS, cs_idle_level);
+    fast_gpio_wait(&deadline, half_period);
+
+    return ESP_OK;
+}
+#endif
+
+#if PANEL_IO_3WIRE_SPI_EXPANDER_BATCH
+/**
+ * @brief Write a package of data to LCD panel in big-endian order, as one sequence of IO expander output levels
+ *
+ * Every step of the waveform of `spi_write_package()` becomes one output register value: SDA changes with the inactive
+ * SCL edge, no delays are needed as a register write takes longer than the SCL half period.
+ *
+ * @param[in] panel_io Pointer to panel IO instance, all lines must be on the IO expander
+ * @param[in] is_cmd   True for command, false for data
+ * @param[in] data     Data to write
+ *
+ * @return
+ *      - ESP_OK:              Success
+ *      - Others:              Fail
+ */
+static esp_err_t expander_write_package(esp_lcd_panel_io_3wire_spi_t *panel_io, bool is_cmd, uint32_t data)
+{
+    uint32_t data_bytes = is_cmd ? panel_io->lcd_cmd_bytes : panel_io->lcd_param_bytes;
+    uint32_t cs_mask = panel_io->cs_io_num;
+    uint32_t scl_mask = panel_io->scl_io_num;
+    uint32_t sda_mask = panel_io->sda_io_num;
+    uint32_t cs_idle = panel_io->flags.cs_high_active ? 0 : cs_mask;
+    uint32_t sda_scl_idle = panel_io->flags.sda_scl_idle_high ? (scl_mask | sda_mask) : 0;
+    uint32_t scl_active_befor = panel_io->flags.scl_active_rising_edge ? 0 : scl_mask;
+    uint32_t scl_active_after = scl_active_befor ^ scl_mask;
+    uint16_t write_order_mask = panel_io->write_order_mask;
+    // Swap command bytes order due to different endianness
+    uint32_t swap_data = SPI_SWAP_DATA_TX(data, data_bytes * 8);
+    int data_dc_bit = is_cmd ? panel_io->cmd_dc_bit : panel_io->param_dc_bit;
+    uint32_t steps[EXPANDER_STEPS_MAX];
+    size_t count = 0;
+
+    // CS active, then SCL before the active edge
+    uint32_t sda = sda_scl_idle & sda_mask;
+    steps[count++] = (cs_idle ^ cs_mask) | (sda_scl_idle & scl_mask) | sda;
+    steps[count++] = (cs_idle ^ cs_mask) | scl_active_befor | sda;
+    // Send data byte by byte, the DC bit before the first byte only
+    for (int i = 0; i < data_bytes; i++) {
+        uint16_t data_temp = swap_data & 0xff;
+        uint8_t data_bits = (i == 0 && data_dc_bit != DATA_NO_DC_BIT) ? 9 : 8;
+        for (uint8_t j = 0; j < data_bits; j++) {
+            if (data_bits == 9 && j == 0) {
+                sda = data_dc_bit ? sda_mask : 0;
+            } else {
+                sda = (data_temp & write_order_mask) ? sda_mask : 0;
+                data_temp = (write_order_mask == WRITE_ORDER_LSB_MASK) ? data_temp >> 1 : data_temp << 1;
+            }
+            steps[count++] = (cs_idle ^ cs_mask) | scl_active_befor | sda;
+            steps[count++] = (cs_idle ^ cs_mask) | scl_active_after | sda;
+        }
+        swap_data >>= 8;
+    }
+    // SCL and SDA idle, then CS inactive
+    steps[count++] = (cs_idle ^ cs_mask) | sda_scl_idle;
+    steps[count++] = cs_idle | sda_scl_idle;
+
+    return esp_io_expander_set_level_sequence(panel_io->io_expander, cs_mask | scl_mask | sda_mask, steps, count);
+}
+#endif
+
+#if PANEL_IO_3WIRE_SPI_USE_HW
+/**
+ * @brief Drive the lines with the SPI peripheral, without DMA
+ *
+ * @note The SPI mode of the peripheral is taken from the line flags: `spi_mode` of the configuration has the idle level
+ *       in bit 0, not the CPOL/CPHA numbering of the SPI master
+ *
+ * @param[in] panel_io Pointer to panel IO instance
+ *
+ * @return
+ *      - ESP_OK:              Success
+ *      - Others:              Fail, the lines are left unused
+ */
+static esp_err_t hw_spi_init(esp_lcd_panel_io_3wire_spi_t *panel_io)
+{
+    esp_err_t ret = ESP_OK;
+    // CPOL is the idle level, CPHA is set when the data is sampled on the second edge of the clock
+    const uint32_t cpol = panel_io->flags.sda_scl_idle_high;
+    const uint32_t cpha = panel_io->flags.scl_active_rising_edge == panel_io->flags.sda_scl_idle_high;
+    const spi_bus_config_t bus_config = {
+        .mosi_io_num = panel_io->sda_io_num,
+        .miso_io_num = -1,
+        .sclk_io_num = panel_io->scl_io_num,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = HW_TRANS_BYTES_MAX,
+    };
+    ESP_RETURN_ON_ERROR(spi_bus_initialize(PANEL_IO_3WIRE_SPI_HOST, &bus_config, SPI_DMA_DISABLED), TAG, "SPI bus init failed");
+
+    const spi_device_interface_config_t dev_config = {
+        .mode = (cpol << 1) | cpha,
+        .clock_speed_hz = PANEL_IO_3WIRE_SPI_HW_CLK,
+        .spics_io_num = panel_io->cs_io_num,
+        .flags = panel_io->flags.cs_high_active ? SPI_DEVICE_POSITIVE_CS : 0,
+        .queue_size = 1,
+    };
+    ESP_GOTO_ON_ERROR(spi_bus_add_device(PANEL_IO_3WIRE_SPI_HOST, &dev_config, &panel_io->spi_dev), err, TAG, "SPI device add failed");
+
+    return ESP_OK;
+
+err:
+    spi_bus_free(PANEL_IO_3WIRE_SPI_HOST);
+    return ret;
+}
+#endif
+
+/**
+ * @brief Append bits to the transmit buffer, MSB first
+ */
+static void hw_spi_put_bits(uint8_t *buf, size_t *bit_pos, uint32_t data, uint8_t bits)
+{
+    while (bits--) {
+        if (data & BIT(bits)) {
+            buf[*bit_pos >> 3] |= 0x80 >> (*bit_pos & 0x7);
+        }
+        (*bit_pos)++;
+    }
+}
+
+/**
+ * @brief Reverse the bits of a byte for LSB first transmission
+ */
+static uint8_t hw_spi_reverse_bits(uint8_t data)
+{
+    data = (data & 0xF0) >> 4 | (data & 0x0F) << 4;
+    data = (data & 0xCC) >> 2 | (data & 0x33) << 2;
+    return (data & 0xAA) >> 1 | (data & 0x55) << 1;
+}
+
+/**
+ * @brief Append a package in the same bit order as `spi_write_package()`
+ */
+static void hw_spi_put_package(esp_lcd_panel_io_3wire_spi_t *panel_io, uint8_t *buf, size_t *bit_pos, bool is_cmd, uint32_t data)
+{
+    uint32_t data_bytes = is_cmd ? panel_io->lcd_cmd_bytes : panel_io->lcd_param_bytes;
+    uint32_t swap_data = SPI_SWAP_DATA_TX(data, data_bytes * 8);
+    int data_dc_bit = is_cmd ? panel_io->cmd_dc_bit : panel_io->param_dc_bit;
+
+    if (data_dc_bit != DATA_NO_DC_BIT) {
+        hw_spi_put_bits(buf, bit_pos, data_dc_bit, 1);
+    }
+    for (int i = 0; i < data_bytes; i++) {
+        uint8_t byte = swap_data & 0xff;
+        hw_spi_put_bits(buf, bit_pos, panel_io->write_order_mask == WRITE_ORDER_LSB_MASK ? hw_spi_reverse_bits(byte) : byte, 8);
+        swap_data >>= 8;
+    }
+}
+
+/**
+ * @brief Send the bits in the transmit buffer as one transaction and clear it
+ */
+static esp_err_t hw_spi_flush(esp_lcd_panel_io_3wire_spi_t *panel_io, uint8_t *buf, size_t *bit_pos)
+{
+    if (*bit_pos == 0) {
+        return ESP_OK;
+    }
+
+    spi_transaction_t trans = {
+        .length = *bit_pos,
+        .tx_buffer = buf,
+    };
+    ESP_RETURN_ON_ERROR(spi_device_polling_transmit(panel_io->spi_dev, &trans), TAG, "SPI transmit failed");
+    memset(buf, 0, HW_TRANS_BYTES_MAX);
+    *bit_pos = 0;
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Send a command and its parameters through the SPI peripheral
+ *
+ * The packages (DC bit and data bytes) are streamed into transactions of up to `HW_TRANS_BYTES_MAX` bytes,
+ * CS is only released between transactions, after a complete package.
+ *
+ * @param[in] panel_io   Pointer to panel IO instance
+ * @param[in] lcd_cmd    Command, negative if none
+ * @param[in] param      Parameters
+ * @param[in] param_size Size of the parameters in bytes
+ *
+ * @return
+ *      - ESP_OK:              Success
+ *      - Others:              Fail
+ */
+static esp_err_t hw_spi_tx_param(esp_lcd_panel_io_3wire_spi_t *panel_io, int lcd_cmd, const void *param, size_t param_size)
+{
+    uint8_t buf[HW_TRANS_BYTES_MAX] = {0};
+    size_t bit_pos = 0;
+    // Largest package: DC bit and 4 bytes
+    const size_t package_bits_max = 1 + LCD_CMD_BYTES_MAX * 8;
+
+    // Send command
+    if (lcd_cmd >= 0) {
+        hw_spi_put_package(panel_io, buf, &bit_pos, true, lcd_cmd);
+    }
+
+    // Send parameter
+    if (param != NULL && param_size > 0) {
+        uint32_t param_bytes = panel_io->lcd_param_bytes;
+        size_t param_count = param_size / param_bytes;
+
+        for (int i = 0; i < param_count; i++) {
+            if (bit_pos + package_bits_max > HW_TRANS_BYTES_MAX * 8) {
+                ESP_RETURN_ON_ERROR(hw_spi_flush(panel_io, buf, &bit_pos), TAG, "SPI flush failed");
+            }
+            uint32_t param_data = 0;
+            for (int j = 0; j < param_bytes; j++) {
+                param_data |= ((uint8_t *)param)[i * param_bytes + j] << (j * 8);
+            }
+            hw_spi_put_package(panel_io, buf, &bit_pos, false, param_data);
+        }
+    }
+
+    return hw_spi_flush(panel_io, buf, &bit_pos);
+}
+
 #endif
\ No newline at end of file
@@ -2,409 +2,154 @@
 
 #include <esp_panel_axs15231b.h>
 #include <esp32-hal-log.h>
-#include <esp_rom_gpio.h>
 #include <esp_heap_caps.h>
-#include <memory.h>
-#include <esp_lcd_panel_commands.h>
-#include <esp_lcd_types.h>
-#include <esp_lcd_panel_interface.h>
-#include <esp_lcd_panel_io.h>
+#include <esp_lcd_panel_io_interface.h>
+
+static const uint8_t axs15231b_vendor_specific_init_default[] = {
+    0xBB, 8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5A, 0xA5,
+    0xA0, 17, 0x00, 0x10, 0x00, 0x02, 0x00, 0x00, 0x64, 0x3F, 0x20, 0x05, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xA2, 31, 0x30, 0x04, 0x0A, 0x3C, 0xEC, 0x54, 0xC4, 0x30, 0xAC, 0x28, 0x7F, 0x7F, 0x7F, 0x20, 0xF8, 0x10, 0x02, 0xFF, 0xFF, 0xF0, 0x90, 0x01, 0x32, 0xA0, 0x91, 0xC0, 0x20, 0x7F, 0xFF, 0x00, 0x54,
+    0xD0, 30, 0x30, 0xAC, 0x21, 0x24, 0x08, 0x09, 0x10, 0x01, 0xAA, 0x14, 0xC2, 0x00, 0x22, 0x22, 0xAA, 0x03, 0x10, 0x12, 0x40, 0x14, 0x1E, 0x51, 0x15, 0x00, 0x40, 0x10, 0x00, 0x03, 0x3D, 0x12,
+    0xA3, 22, 0xA0, 0x06, 0xAA, 0x08, 0x08, 0x02, 0x0A, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x55, 0x55,
+    0xC1, 30, 0x33, 0x04, 0x02, 0x02, 0x71, 0x05, 0x24, 0x55, 0x02, 0x00, 0x41, 0x00, 0x53, 0xFF, 0xFF, 0xFF, 0x4F, 0x52, 0x00, 0x4F, 0x52, 0x00, 0x45, 0x3B, 0x0B, 0x02, 0x0D, 0x00, 0xFF, 0x40,
+    0xC3, 11, 0x00, 0x00, 0x00, 0x50, 0x03, 0x00, 0x00, 0x00, 0x01, 0x80, 0x01,
+    0xC4, 29, 0x00, 0x24, 0x33, 0x90, 0x50, 0xEA, 0x64, 0x32, 0xC8, 0x64, 0xC8, 0x32, 0x90, 0x90, 0x11, 0x06, 0xDC, 0xFA, 0x04, 0x03, 0x80, 0xFE, 0x10, 0x10, 0x00, 0x0A, 0x0A, 0x44, 0x50,
+    0xC5, 23, 0x18, 0x00, 0x00, 0x03, 0xFE, 0x78, 0x33, 0x20, 0x30, 0x10, 0x88, 0xDE, 0x0D, 0x08, 0x0F, 0x0F, 0x01, 0x78, 0x33, 0x20, 0x10, 0x10, 0x80,
+    0xC6, 20, 0x05, 0x0A, 0x05, 0x0A, 0x00, 0xE0, 0x2E, 0x0B, 0x12, 0x22, 0x12, 0x22, 0x01, 0x00, 0x00, 0x3F, 0x6A, 0x18, 0xC8, 0x22,
+    0xC7, 20, 0x50, 0x32, 0x28, 0x00, 0xA2, 0x80, 0x8F, 0x00, 0x80, 0xFF, 0x07, 0x11, 0x9F, 0x6F, 0xFF, 0x26, 0x0C, 0x0D, 0x0E, 0x0F,
+    0xC9, 4, 0x33, 0x44, 0x44, 0x01,
+    0xCF, 27, 0x34, 0x1E, 0x88, 0x58, 0x13, 0x18, 0x56, 0x18, 0x1E, 0x68, 0xF7, 0x00, 0x65, 0x0C, 0x22, 0xC4, 0x0C, 0x77, 0x22, 0x44, 0xAA, 0x55, 0x04, 0x04, 0x12, 0xA0, 0x08,
+    0xD5, 30, 0x3E, 0x3E, 0x88, 0x00, 0x44, 0x04, 0x78, 0x33, 0x20, 0x78, 0x33, 0x20, 0x04, 0x28, 0xD3, 0x47, 0x03, 0x03, 0x03, 0x03, 0x86, 0x00, 0x00, 0x00, 0x30, 0x52, 0x3F, 0x40, 0x40, 0x96,
+    0xD6, 30, 0x10, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE, 0x95, 0x00, 0x01, 0x83, 0x75, 0x36, 0x20, 0x75, 0x36, 0x20, 0x3F, 0x03, 0x03, 0x03, 0x10, 0x10, 0x00, 0x04, 0x51, 0x20, 0x01, 0x00,
+    0xD7, 19, 0x0A, 0x08, 0x0E, 0x0C, 0x1E, 0x18, 0x19, 0x1F, 0x00, 0x1F, 0x1A, 0x1F, 0x3E, 0x3E, 0x04, 0x00, 0x1F, 0x1F, 0x1F,
+    0xD8, 12, 0x0B, 0x09, 0x0F, 0x0D, 0x1E, 0x18, 0x19, 0x1F, 0x01, 0x1F, 0x1A, 0x1F,
+    0xD9, 13, 0x00, 0x0D, 0x0F, 0x09, 0x0B, 0x1F, 0x18, 0x19, 0x1F, 0x01, 0x1E, 0x1A, 0x1F,
+    0xDD, 12, 0x0C, 0x0E, 0x08, 0x0A, 0x1F, 0x18, 0x19, 0x1F, 0x00, 0x1E, 0x1A, 0x1F,
+    0xDF, 8, 0x44, 0x73, 0x4B, 0x69, 0x00, 0x0A, 0x02, 0x90,
+    0xE0, 17, 0x19, 0x20, 0x0A, 0x13, 0x0E, 0x09, 0x12, 0x28, 0xD4, 0x24, 0x0C, 0x35, 0x13, 0x31, 0x36, 0x2F, 0x03,
+    0xE1, 17, 0x38, 0x20, 0x09, 0x12, 0x0E, 0x08, 0x12, 0x28, 0xC5, 0x24, 0x0C, 0x34, 0x12, 0x31, 0x36, 0x2F, 0x27,
+    0xE2, 17, 0x19, 0x20, 0x0A, 0x11, 0x09, 0x06, 0x11, 0x25, 0xD4, 0x22, 0x0B, 0x33, 0x12, 0x2D, 0x32, 0x2F, 0x03,
+    0xE3, 17, 0x38, 0x20, 0x0A, 0x11, 0x09, 0x06, 0x11, 0x25, 0xC4, 0x21, 0x0A, 0x32, 0x11, 0x2C, 0x32, 0x2F, 0x27,
+    0xE4, 17, 0x19, 0x20, 0x0D, 0x14, 0x0D, 0x08, 0x12, 0x2A, 0xD4, 0x26, 0x0E, 0x35, 0x13, 0x34, 0x39, 0x2F, 0x03,
+    0xE5, 17, 0x38, 0x20, 0x0D, 0x13, 0x0D, 0x07, 0x12, 0x29, 0xC4, 0x25, 0x0D, 0x35, 0x12, 0x33, 0x39, 0x2F, 0x27,
+    0xBB, 8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x13, 0,
+    0x11, 0 | LCD_INIT_DELAY, 200,
+    0x29, 0 | LCD_INIT_DELAY, 200,
+    0x2C, 4, 0x00, 0x00, 0x00, 0x00,
+    // All Pixels off
+    0x22, 0 | LCD_INIT_DELAY, 200,
+};
+
+static const dcs_panel_descriptor_t axs15231b_descriptor = {
+    .name = "AXS15231B",
+    .init_bytecode = axs15231b_vendor_specific_init_default,
+    .init_bytecode_size = sizeof(axs15231b_vendor_specific_init_default),
+    .colmod_rgb444 = 0,
+    .colmod_rgb565 = 0x55,
+    .colmod_rgb666 = 0x66,
+    .colmod_rgb888 = 0,
+    .gram_lines = 0,
+    .ramrd = false,
+    .frame_rates = NULL,
+    .reset_delay_ms = 100,
+    .slpout_delay_ms = 100,
+    .quirks = DCS_QUIRK_SOFTWARE_RESET | DCS_QUIRK_INIT_IN_RESET | DCS_QUIRK_SLPOUT_FIRST};
+
+// In QSPI mode the controller ignores RASET
+static const dcs_panel_descriptor_t axs15231b_qspi_descriptor = {
+    .name = "AXS15231B QSPI",
+    .init_bytecode = axs15231b_vendor_specific_init_default,
+    .init_bytecode_size = sizeof(axs15231b_vendor_specific_init_default),
+    .colmod_rgb444 = 0,
+    .colmod_rgb565 = 0x55,
+    .colmod_rgb666 = 0x66,
+    .colmod_rgb888 = 0,
+    .gram_lines = 0,
+    .ramrd = false,
+    .frame_rates = NULL,
+    .reset_delay_ms = 100,
+    .slpout_delay_ms = 100,
+    .quirks = DCS_QUIRK_SOFTWARE_RESET | DCS_QUIRK_INIT_IN_RESET | DCS_QUIRK_SLPOUT_FIRST | DCS_QUIRK_RAMWRC_CONTINUE};
+
+// QSPI framing: opcode in the upper byte, DCS command in bits 8-15 (sent as the 32 bit command phase)
+#define AXS15231B_QSPI_OPCODE_WRITE_CMD 0x02
+#define AXS15231B_QSPI_OPCODE_READ_CMD 0x0B
+#define AXS15231B_QSPI_OPCODE_WRITE_COLOR 0x32
+#define AXS15231B_QSPI_CMD(opcode, cmd) (((opcode) << 24) | (((cmd) & 0xFF) << 8))
 
 typedef struct
 {
-    esp_lcd_panel_t base;
-    esp_lcd_panel_io_handle_t panel_io_handle;
-    esp_lcd_panel_dev_config_t panel_dev_config;
-    // Data
-    int x_gap;
-    int y_gap;
-    uint8_t madctl;
-} axs15231b_panel_t;
-
-const lcd_init_cmd_t axs15231b_vendor_specific_init_default[] = {
-    {0xBB, (uint8_t[]){0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5A, 0xA5}, 8, 0},
-    {0xA0, (uint8_t[]){0x00, 0x10, 0x00, 0x02, 0x00, 0x00, 0x64, 0x3F, 0x20, 0x05, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00}, 17, 0},
-    {0xA2, (uint8_t[]){0x30, 0x04, 0x0A, 0x3C, 0xEC, 0x54, 0xC4, 0x30, 0xAC, 0x28, 0x7F, 0x7F, 0x7F, 0x20, 0xF8, 0x10, 0x02, 0xFF, 0xFF, 0xF0, 0x90, 0x01, 0x32, 0xA0, 0x91, 0xC0, 0x20, 0x7F, 0xFF, 0x00, 0x54}, 31, 0},
-    {0xD0, (uint8_t[]){0x30, 0xAC, 0x21, 0x24, 0x08, 0x09, 0x10, 0x01, 0xAA, 0x14, 0xC2, 0x00, 0x22, 0x22, 0xAA, 0x03, 0x10, 0x12, 0x40, 0x14, 0x1E, 0x51, 0x15, 0x00, 0x40, 0x10, 0x00, 0x03, 0x3D, 0x12}, 30, 0},
-    {0xA3, (uint8_t[]){0xA0, 0x06, 0xAA, 0x08, 0x08, 0x02, 0x0A, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x55, 0x55}, 22, 0},
-    {0xC1, (uint8_t[]){0x33, 0x04, 0x02, 0x02, 0x71, 0x05, 0x24, 0x55, 0x02, 0x00, 0x41, 0x00, 0x53, 0xFF, 0xFF, 0xFF, 0x4F, 0x52, 0x00, 0x4F, 0x52, 0x00, 0x45, 0x3B, 0x0B, 0x02, 0x0D, 0x00, 0xFF, 0x40}, 30, 0},
-    {0xC3, (uint8_t[]){0x00, 0x00, 0x00, 0x50, 0x03, 0x00, 0x00, 0x00, 0x01, 0x80, 0x01}, 11, 0},
-    {0xC4, (uint8_t[]){0x00, 0x24, 0x33, 0x90, 0x50, 0xea, 0x64, 0x32, 0xC8, 0x64, 0xC8, 0x32, 0x90, 0x90, 0x11, 0x06, 0xDC, 0xFA, 0x04, 0x03, 0x80, 0xFE, 0x10, 0x10, 0x00, 0x0A, 0x0A, 0x44, 0x50}, 29, 0},
-    {0xC5, (uint8_t[]){0x18, 0x00, 0x00, 0x03, 0xFE, 0x78, 0x33, 0x20, 0x30, 0x10, 0x88, 0xDE, 0x0D, 0x08, 0x0F, 0x0F, 0x01, 0x78, 0x33, 0x20, 0x10, 0x10, 0x80}, 23, 0},
-    {0xC6, (uint8_t[]){0x05, 0x0A, 0x05, 0x0A, 0x00, 0xE0, 0x2E, 0x0B, 0x12, 0x22, 0x12, 0x22, 0x01, 0x00, 0x00, 0x3F, 0x6A, 0x18, 0xC8, 0x22}, 20, 0},
-    {0xC7, (uint8_t[]){0x50, 0x32, 0x28, 0x00, 0xa2, 0x80, 0x8f, 0x00, 0x80, 0xff, 0x07, 0x11, 0x9F, 0x6f, 0xff, 0x26, 0x0c, 0x0d, 0x0e, 0x0f}, 20, 0},
-    {0xC9, (uint8_t[]){0x33, 0x44, 0x44, 0x01}, 4, 0},
-    {0xCF, (uint8_t[]){0x34, 0x1E, 0x88, 0x58, 0x13, 0x18, 0x56, 0x18, 0x1E, 0x68, 0xF7, 0x00, 0x65, 0x0C, 0x22, 0xC4, 0x0C, 0x77, 0x22, 0x44, 0xAA, 0x55, 0x04, 0x04, 0x12, 0xA0, 0x08}, 27, 0},
-    {0xD5, (uint8_t[]){0x3E, 0x3E, 0x88, 0x00, 0x44, 0x04, 0x78, 0x33, 0x20, 0x78, 0x33, 0x20, 0x04, 0x28, 0xD3, 0x47, 0x03, 0x03, 0x03, 0x03, 0x86, 0x00, 0x00, 0x00, 0x30, 0x52, 0x3f, 0x40, 0x40, 0x96}, 30, 0},
-    {0xD6, (uint8_t[]){0x10, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE, 0x95, 0x00, 0x01, 0x83, 0x75, 0x36, 0x20, 0x75, 0x36, 0x20, 0x3F, 0x03, 0x03, 0x03, 0x10, 0x10, 0x00, 0x04, 0x51, 0x20, 0x01, 0x00}, 30, 0},
-    {0xD7, (uint8_t[]){0x0a, 0x08, 0x0e, 0x0c, 0x1E, 0x18, 0x19, 0x1F, 0x00, 0x1F, 0x1A, 0x1F, 0x3E, 0x3E, 0x04, 0x00, 0x1F, 0x1F, 0x1F}, 19, 0},
-    {0xD8, (uint8_t[]){0x0B, 0x09, 0x0F, 0x0D, 0x1E, 0x18, 0x19, 0x1F, 0x01, 0x1F, 0x1A, 0x1F}, 12, 0},
-    {0xD9, (uint8_t[]){0x00, 0x0D, 0x0F, 0x09, 0x0B, 0x1F, 0x18, 0x19, 0x1F, 0x01, 0x1E, 0x1A, 0x1F}, 13, 0},
-    {0xDD, (uint8_t[]){0x0C, 0x0E, 0x08, 0x0A, 0x1F, 0x18, 0x19, 0x1F, 0x00, 0x1E, 0x1A, 0x1F}, 12, 0},
-    {0xDF, (uint8_t[]){0x44, 0x73, 0x4B, 0x69, 0x00, 0x0A, 0x02, 0x90}, 8, 0},
-    {0xE0, (uint8_t[]){0x19, 0x20, 0x0A, 0x13, 0x0E, 0x09, 0x12, 0x28, 0xD4, 0x24, 0x0C, 0x35, 0x13, 0x31, 0x36, 0x2f, 0x03}, 17, 0},
-    {0xE1, (uint8_t[]){0x38, 0x20, 0x09, 0x12, 0x0E, 0x08, 0x12, 0x28, 0xC5, 0x24, 0x0C, 0x34, 0x12, 0x31, 0x36, 0x2f, 0x27}, 17, 0},
-    {0xE2, (uint8_t[]){0x19, 0x20, 0x0A, 0x11, 0x09, 0x06, 0x11, 0x25, 0xD4, 0x22, 0x0B, 0x33, 0x12, 0x2D, 0x32, 0x2f, 0x03}, 17, 0},
-    {0xE3, (uint8_t[]){0x38, 0x20, 0x0A, 0x11, 0x09, 0x06, 0x11, 0x25, 0xC4, 0x21, 0x0A, 0x32, 0x11, 0x2C, 0x32, 0x2f, 0x27}, 17, 0},
-    {0xE4, (uint8_t[]){0x19, 0x20, 0x0D, 0x14, 0x0D, 0x08, 0x12, 0x2A, 0xD4, 0x26, 0x0E, 0x35, 0x13, 0x34, 0x39, 0x2f, 0x03}, 17, 0},
-    {0xE5, (uint8_t[]){0x38, 0x20, 0x0D, 0x13, 0x0D, 0x07, 0x12, 0x29, 0xC4, 0x25, 0x0D, 0x35, 0x12, 0x33, 0x39, 0x2f, 0x27}, 17, 0},
-    {0xBB, (uint8_t[]){0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, 8, 0},
-    {0x13, (uint8_t[]){0x00}, 0, 0},
-    {0x11, (uint8_t[]){0x00}, 0, 200},
-    {0x29, (uint8_t[]){0x00}, 0, 200},
-    {0x2C, (uint8_t[]){0x00, 0x00, 0x00, 0x00}, 4, 0},
-    // All Pixels off
-    {0x22, (uint8_t[]){0x00}, 0, 200}};
+    esp_lcd_panel_io_t base;
+    esp_lcd_panel_io_handle_t io;
+} axs15231b_qspi_io_t;
 
-esp_err_t axs15231b_reset(esp_lcd_panel_t *panel)
+static esp_err_t axs15231b_qspi_rx_param(esp_lcd_panel_io_t *io, int lcd_cmd, void *param, size_t param_size)
 {
-    log_v("panel:0x%08x", panel);
-    if (panel == NULL)
-        return ESP_ERR_INVALID_ARG;
-
-    const axs15231b_panel_t *ph = (axs15231b_panel_t *)panel;
-
-    esp_err_t res;
-    if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_SWRESET, NULL, 0)) != ESP_OK)
-    {
-        log_e("Sending LCD_CMD_SWRESET failed");
-        return res;
-    }
-
-    vTaskDelay(pdMS_TO_TICKS(100));
-
-    uint8_t colmod;
-    switch (ph->panel_dev_config.bits_per_pixel)
-    {
-    case 16: // RGB565
-        colmod = 0x55;
-        break;
-    case 18: // RGB666
-        colmod = 0x66;
-        break;
-    default:
-        log_e("Invalid bits per pixel: %d. Only RGB565 and RGB666 are supported", ph->panel_dev_config.bits_per_pixel);
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_MADCTL, &ph->madctl, 1)) != ESP_OK ||
-        (res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_COLMOD, &colmod, 1)) != ESP_OK)
-    {
-        log_e("Sending MADCTL/COLMOD failed");
-        return res;
-    }
-
-    const lcd_init_cmd_t *cmd = axs15231b_vendor_specific_init_default;
-    uint16_t cmds_size = sizeof(axs15231b_vendor_specific_init_default) / sizeof(lcd_init_cmd_t);
-    if (ph->panel_dev_config.vendor_config != NULL)
-    {
-        cmd = ((axs15231b_vendor_config_t *)ph->panel_dev_config.vendor_config)->init_cmds;
-        cmds_size = ((axs15231b_vendor_config_t *)ph->panel_dev_config.vendor_config)->init_cmds_size;
-    }
-
-    while (cmds_size-- > 0)
-    {
-        if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, cmd->cmd, cmd->data, cmd->bytes)) != ESP_OK)
-        {
-            log_e("Sending command: 0x%02x failed", cmd->cmd);
-            return res;
-        }
-
-        vTaskDelay(pdMS_TO_TICKS(cmd->delay_ms));
-        cmd++;
-    }
-
-    return ESP_OK;
+    axs15231b_qspi_io_t *qspi_io = __containerof(io, axs15231b_qspi_io_t, base);
+    return esp_lcd_panel_io_rx_param(qspi_io->io, AXS15231B_QSPI_CMD(AXS15231B_QSPI_OPCODE_READ_CMD, lcd_cmd), param, param_size);
 }
 
-esp_err_t axs15231b_init(esp_lcd_panel_t *panel)
+static esp_err_t axs15231b_qspi_tx_param(esp_lcd_panel_io_t *io, int lcd_cmd, const void *param, size_t param_size)
 {
-    log_v("panel:0x%08x", panel);
-    if (panel == NULL)
-        return ESP_ERR_INVALID_ARG;
-
-    const axs15231b_panel_t *ph = (axs15231b_panel_t *)panel;
-
-    esp_err_t res;
-    if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_SLPOUT, NULL, 0)) != ESP_OK)
-    {
-        log_e("Sending SLPOUT failed");
-        return res;
-    }
-
-    vTaskDelay(pdMS_TO_TICKS(100));
-
-    uint8_t colmod;
-    switch (ph->panel_dev_config.bits_per_pixel)
-    {
-    case 16: // RGB565
-        colmod = 0x55;
-        break;
-    case 18: // RGB666
-        colmod = 0x66;
-        break;
-    default:
-        log_e("Invalid bits per pixel: %d. Only RGB565 and RGB666 are supported", ph->panel_dev_config.bits_per_pixel);
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_MADCTL, &ph->madctl, 1)) != ESP_OK ||
-        (res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_COLMOD, &colmod, 1)) != ESP_OK)
-    {
-        log_e("Sending MADCTL/COLMOD failed");
-        return res;
-    }
-
-    const lcd_init_cmd_t *cmd = axs15231b_vendor_specific_init_default;
-    uint16_t cmds_size = sizeof(axs15231b_vendor_specific_init_default) / sizeof(lcd_init_cmd_t);
-    if (ph->panel_dev_config.vendor_config != NULL)
-    {
-        cmd = ((axs15231b_vendor_config_t *)ph->panel_dev_config.vendor_config)->init_cmds;
-        cmds_size = ((axs15231b_vendor_config_t *)ph->panel_dev_config.vendor_config)->init_cmds_size;
-    }
-
-    while (cmds_size-- > 0)
-    {
-        if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, cmd->cmd, cmd->data, cmd->bytes)) != ESP_OK)
-        {
-            log_e("Sending command: 0x%02x failed", cmd->cmd);
-            return res;
-        }
-
-        vTaskDelay(pdMS_TO_TICKS(cmd->delay_ms));
-        cmd++;
-    }
-
-    return ESP_OK;
+    axs15231b_qspi_io_t *qspi_io = __containerof(io, axs15231b_qspi_io_t, base);
+    return esp_lcd_panel_io_tx_param(qspi_io->io, AXS15231B_QSPI_CMD(AXS15231B_QSPI_OPCODE_WRITE_CMD, lcd_cmd), param, param_size);
 }
 
-esp_err_t axs15231b_draw_bitmap(esp_lcd_panel_t *panel, int x_start, int y_start, int x_end, int y_end, const void *color_data)
+static esp_err_t axs15231b_qspi_tx_color(esp_lcd_panel_io_t *io, int lcd_cmd, const void *color, size_t color_size)
 {
-    log_v("panel:0x%08x, x_start:%d, y_start:%d, x_end:%d, y_end:%d, color_data:0x%08x", panel, x_start, y_start, x_end, y_end, color_data);
-    if (panel == NULL || color_data == NULL)
-        return ESP_ERR_INVALID_ARG;
-
-    const axs15231b_panel_t *ph = (axs15231b_panel_t *)panel;
-
-    if (x_start >= x_end)
-    {
-        log_w("X-start greater than the x-end");
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    if (y_start >= y_end)
-    {
-        log_w("Y-start greater than the y-end");
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    // Correct for gap
-    x_start += ph->x_gap;
-    x_end += ph->x_gap;
-    y_start += ph->y_gap;
-    y_end += ph->y_gap;
-
-    esp_err_t res;
-    const uint8_t caset[4] = {x_start >> 8, x_start, (x_end - 1) >> 8, x_end - 1};
-    const uint8_t raset[4] = {y_start >> 8, y_start, (y_end - 1) >> 8, y_end - 1};
-    if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_CASET, caset, sizeof(caset))) != ESP_OK ||
-        (res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_RASET, raset, sizeof(raset))) != ESP_OK)
-    {
-        log_e("Sending CASET/RASET failed");
-        return res;
-    }
-
-    uint8_t bytes_per_pixel = (ph->panel_dev_config.bits_per_pixel + 0x7) >> 3;
-    size_t len = (x_end - x_start) * (y_end - y_start) * bytes_per_pixel;
-    if ((res = esp_lcd_panel_io_tx_color(ph->panel_io_handle, LCD_CMD_RAMWR, color_data, len)) != ESP_OK)
-    {
-        log_e("Sending RAMWR failed");
-        return res;
-    }
-
-    return ESP_OK;
+    axs15231b_qspi_io_t *qspi_io = __containerof(io, axs15231b_qspi_io_t, base);
+    return esp_lcd_panel_io_tx_color(qspi_io->io, AXS15231B_QSPI_CMD(AXS15231B_QSPI_OPCODE_WRITE_COLOR, lcd_cmd), color, color_size);
 }
 
-esp_err_t axs15231b_invert_color(esp_lcd_panel_t *panel, bool invert)
+static esp_err_t axs15231b_qspi_register_event_callbacks(esp_lcd_panel_io_t *io, const esp_lcd_panel_io_callbacks_t *cbs, void *user_ctx)
 {
-    log_v("panel:0x%08x, invert:%d", panel, invert);
-    if (panel == NULL)
-        return ESP_ERR_INVALID_ARG;
-
-    const axs15231b_panel_t *ph = (axs15231b_panel_t *)panel;
-
-    esp_err_t res;
-    if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, invert ? LCD_CMD_INVON : LCD_CMD_INVOFF, NULL, 0)) != ESP_OK)
-    {
-        log_e("Sending LCD_CMD_INVON/LCD_CMD_INVOFF failed");
-        return res;
-    }
-
-    return ESP_OK;
+    axs15231b_qspi_io_t *qspi_io = __containerof(io, axs15231b_qspi_io_t, base);
+    return esp_lcd_panel_io_register_event_callbacks(qspi_io->io, cbs, user_ctx);
 }
 
-esp_err_t axs15231b_update_madctl(axs15231b_panel_t *ph)
+static esp_err_t axs15231b_qspi_del(esp_lcd_panel_io_t *io)
 {
-    esp_err_t res;
-    if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_MADCTL, &ph->madctl, 1)) != ESP_OK)
-    {
-        log_e("Sending LCD_CMD_MADCTL failed");
-        return res;
-    }
-
-    return ESP_OK;
+    axs15231b_qspi_io_t *qspi_io = __containerof(io, axs15231b_qspi_io_t, base);
+    esp_err_t res = esp_lcd_panel_io_del(qspi_io->io);
+    free(qspi_io);
+    return res;
 }
 
-esp_err_t axs15231b_mirror(esp_lcd_panel_t *panel, bool mirror_x, bool mirror_y)
+esp_err_t esp_lcd_new_panel_io_axs15231b_qspi(const esp_lcd_panel_io_handle_t spi_io_handle, esp_lcd_panel_io_handle_t *io_handle)
 {
-    log_v("panel:0x%08x, mirror_x:%d, mirror_y:%d", panel, mirror_x, mirror_y);
-    if (panel == NULL)
+    log_v("spi_io_handle:0x%08x, io_handle:0x%08x", spi_io_handle, io_handle);
+    if (spi_io_handle == NULL || io_handle == NULL)
         return ESP_ERR_INVALID_ARG;
 
-    axs15231b_panel_t *ph = (axs15231b_panel_t *)panel;
-
-    if (mirror_x)
-        ph->madctl |= LCD_CMD_MX_BIT;
-    else
-        ph->madctl &= ~LCD_CMD_MX_BIT;
-
-    if (mirror_y)
-        ph->madctl |= LCD_CMD_MY_BIT;
-    else
-        ph->madctl &= ~LCD_CMD_MY_BIT;
-
-    return axs15231b_update_madctl(ph);
-}
-
-esp_err_t axs15231b_swap_xy(esp_lcd_panel_t *panel, bool swap_xy)
-{
-    log_v("panel:0x%08x, swap_xy:%d", panel, swap_xy);
-    if (panel == NULL)
-        return ESP_ERR_INVALID_ARG;
-
-    axs15231b_panel_t *ph = (axs15231b_panel_t *)panel;
-
-    if (swap_xy)
-        ph->madctl |= LCD_CMD_MV_BIT;
-    else
-        ph->madctl &= ~LCD_CMD_MV_BIT;
-
-    return axs15231b_update_madctl(ph);
-}
-
-esp_err_t axs15231b_set_gap(esp_lcd_panel_t *panel, int x_gap, int y_gap)
-{
-    log_v("panel:0x%08x, x_gap:%d, y_gap:%d", panel, x_gap, y_gap);
-    if (panel == NULL)
-        return ESP_ERR_INVALID_ARG;
-
-    axs15231b_panel_t *ph = (axs15231b_panel_t *)panel;
-
-    ph->x_gap = x_gap;
-    ph->y_gap = y_gap;
-
-    return ESP_OK;
-}
-
-esp_err_t axs15231b_disp_off(esp_lcd_panel_t *panel, bool off)
-{
-    log_v("panel:0x%08x, off:%d", panel, off);
-    if (panel == NULL)
-        return ESP_ERR_INVALID_ARG;
-
-    const axs15231b_panel_t *ph = (axs15231b_panel_t *)panel;
-
-    esp_err_t res;
-    if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, off ? LCD_CMD_DISPOFF : LCD_CMD_DISPON, NULL, 0)) != ESP_OK)
+    axs15231b_qspi_io_t *qspi_io = heap_caps_calloc(1, sizeof(axs15231b_qspi_io_t), MALLOC_CAP_DEFAULT);
+    if (qspi_io == NULL)
     {
-        log_e("Sending LCD_CMD_DISPOFF/LCD_CMD_DISPON failed");
-        return res;
+        log_e("No memory available for axs15231b_qspi_io_t");
+        return ESP_ERR_NO_MEM;
     }
 
-    return ESP_OK;
-}
-
-esp_err_t axs15231b_del(esp_lcd_panel_t *panel)
-{
-    log_v("panel:0x%08x", panel);
-    if (panel == NULL)
-        return ESP_ERR_INVALID_ARG;
-
-    axs15231b_panel_t *ph = (axs15231b_panel_t *)panel;
-
-    // Reset RESET
-    if (ph->panel_dev_config.reset_gpio_num != GPIO_NUM_NC)
-        gpio_reset_pin(ph->panel_dev_config.reset_gpio_num);
+    qspi_io->io = spi_io_handle;
+    qspi_io->base.rx_param = axs15231b_qspi_rx_param;
+    qspi_io->base.tx_param = axs15231b_qspi_tx_param;
+    qspi_io->base.tx_color = axs15231b_qspi_tx_color;
+    qspi_io->base.register_event_callbacks = axs15231b_qspi_register_event_callbacks;
+    qspi_io->base.del = axs15231b_qspi_del;
 
-    free(ph);
+    log_d("io_handle: 0x%08x", qspi_io);
+    *io_handle = &qspi_io->base;
 
     return ESP_OK;
 }
 
 esp_err_t esp_lcd_new_panel_axs15231b(const esp_lcd_panel_io_handle_t panel_io_handle, const esp_lcd_panel_dev_config_t *panel_dev_config, esp_lcd_panel_handle_t *panel_handle)
 {
-    log_v("panel_io_handle:0x%08x, panel_dev_config:0x%08x, panel_handle:0x%08x", panel_io_handle, panel_dev_config, panel_handle);
-    if (panel_io_handle == NULL || panel_dev_config == NULL || panel_handle == NULL)
-        return ESP_ERR_INVALID_ARG;
-
-    if (panel_dev_config->reset_gpio_num != GPIO_NUM_NC && !GPIO_IS_VALID_GPIO(panel_dev_config->reset_gpio_num))
-    {
-        log_e("Invalid GPIO RST pin: %d", panel_dev_config->reset_gpio_num);
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    uint8_t madctl;
-    switch (panel_dev_config->color_space)
-    {
-    case ESP_LCD_COLOR_SPACE_RGB:
-        madctl = 0;
-        break;
-    case ESP_LCD_COLOR_SPACE_BGR:
-        madctl = LCD_CMD_BGR_BIT;
-        break;
-    default:
-        log_e("Invalid color space: %d. Only RGB and BGR are supported", panel_dev_config->color_space);
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    if (panel_dev_config->reset_gpio_num != GPIO_NUM_NC)
-    {
-        esp_err_t res;
-        const gpio_config_t cfg = {
-            .pin_bit_mask = BIT64(panel_dev_config->reset_gpio_num),
-            .mode = GPIO_MODE_OUTPUT};
-        if ((res = gpio_config(&cfg)) != ESP_OK)
-        {
-            log_e("Configuring GPIO for RST failed");
-            return res;
-        }
-    }
-
-    axs15231b_panel_t *ph = heap_caps_calloc(1, sizeof(axs15231b_panel_t), MALLOC_CAP_DEFAULT);
-    if (ph == NULL)
-    {
-        log_e("No memory available for axs15231b_panel_t");
-        return ESP_ERR_NO_MEM;
-    }
-
-    ph->panel_io_handle = panel_io_handle;
-    memcpy(&ph->panel_dev_config, panel_dev_config, sizeof(esp_lcd_panel_dev_config_t));
-    ph->madctl = madctl;
-
-    ph->base.del = axs15231b_del;
-    ph->base.reset = axs15231b_reset;
-    ph->base.init = axs15231b_init;
-    ph->base.draw_bitmap = axs15231b_draw_bitmap;
-    ph->base.invert_color = axs15231b_invert_color;
-    ph->base.mirror = axs15231b_mirror;
-    ph->base.swap_xy = axs15231b_swap_xy;
-    ph->base.set_gap = axs15231b_set_gap;
-    ph->base.disp_off = axs15231b_disp_off;
-
-    log_d("panel_handle: 0x%08x", ph);
-    *panel_handle = (esp_lcd_panel_handle_t)ph;
+    return esp_lcd_new_panel_dcs(&axs15231b_descriptor, panel_io_handle, panel_dev_config, panel_handle);
+}
 
-    return ESP_OK;
+esp_err_t esp_lcd_new_panel_axs15231b_qspi(const esp_lcd_panel_io_handle_t panel_io_handle, const esp_lcd_panel_dev_config_t *panel_dev_config, esp_lcd_panel_handle_t *panel_handle)
+{
+    return esp_lcd_new_panel_dcs(&axs15231b_qspi_descriptor, panel_io_handle, panel_dev_config, panel_handle);
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,769 @@
+#if defined(DISPLAY_ILI9341_SPI) || defined(DISPLAY_ST7789_SPI) || defined(DISPLAY_ST7796_SPI) || defined(DISPLAY_GC9A01_SPI) || defined(DISPLAY_AXS15231B_QSPI)
+
+#include <esp_panel_dcs.h>
+#include <esp32-hal-log.h>
+#include <esp_rom_gpio.h>
+#include <esp_heap_caps.h>
+#include <memory.h>
+#include <esp_lcd_panel_commands.h>
+#include <esp_lcd_types.h>
+#include <esp_lcd_panel_interface.h>
+#include <esp_lcd_panel_io.h>
+#include <esp_timer.h>
+#include <sys/param.h>
+#include <stdlib.h>
+
+typedef struct
+{
+    esp_lcd_panel_t base;
+    const dcs_panel_descriptor_t *descriptor;
+    esp_lcd_panel_io_handle_t panel_io_handle;
+    esp_lcd_panel_dev_config_t panel_dev_config;
+    // Data
+    int x_gap;
+    int y_gap;
+    uint8_t madctl;
+    uint8_t colmod;
+    // Last programmed window, CASET/RASET are skipped when unchanged
+    bool caset_valid;
+    bool raset_valid;
+    uint8_t caset[4];
+    uint8_t raset[4];
+    // Earliest time SLPOUT may be sent after a reset
+    int64_t slpout_deadline_us;
+    // Hardware scrolling area (display rows) and offset, height is 0 when not scrolling
+    int scroll_y;
+    int scroll_height;
+    int scroll_offset;
+} dcs_panel_t;
+
+static esp_err_t dcs_tx_init_sequence(dcs_panel_t *ph)
+{
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t res;
+    if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_MADCTL, &ph->madctl, 1)) != ESP_OK ||
+        (res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_COLMOD, &ph->colmod, 1)) != ESP_OK)
+    {
+        log_e("Sending MADCTL/COLMOD failed");
+        return res;
+    }
+
+    const dcs_vendor_config_t *vendor_config = ph->panel_dev_config.vendor_config;
+    if (vendor_config != NULL)
+        res = lcd_tx_init_cmds(ph->panel_io_handle, vendor_config->init_cmds, vendor_config->init_cmds_size);
+    else
+        res = lcd_tx_init_bytecode(ph->panel_io_handle, ph->descriptor->init_bytecode, ph->descriptor->init_bytecode_size);
+
+    if (res != ESP_OK)
+        return res;
+
+    lcd_boot_profile_add(LCD_BOOT_PHASE_INIT_TABLE, start_us);
+    return ESP_OK;
+}
+
+static esp_err_t dcs_tx_slpout(dcs_panel_t *ph)
+{
+    int64_t start_us = esp_timer_get_time();
+    lcd_wait_until(ph->slpout_deadline_us);
+
+    esp_err_t res;
+    if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_SLPOUT, NULL, 0)) != ESP_OK)
+    {
+        log_e("Sending SLPOUT failed");
+        return res;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(ph->descriptor->slpout_delay_ms));
+    lcd_boot_profile_add(LCD_BOOT_PHASE_SLPOUT_WAIT, start_us);
+    return ESP_OK;
+}
+
+esp_err_t dcs_reset(esp_lcd_panel_t *panel)
+{
+    log_v("panel:0x%08x", panel);
+    if (panel == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    dcs_panel_t *ph = (dcs_panel_t *)panel;
+    int64_t start_us = esp_timer_get_time();
+
+    // Controller window and scrolling are reset
+    ph->caset_valid = false;
+    ph->raset_valid = false;
+    ph->scroll_height = 0;
+
+    esp_err_t res;
+    if (ph->panel_dev_config.reset_gpio_num != GPIO_NUM_NC && !(ph->descriptor->quirks & DCS_QUIRK_SOFTWARE_RESET))
+    {
+        // Hardware reset
+        gpio_set_level(ph->panel_dev_config.reset_gpio_num, ph->panel_dev_config.flags.reset_active_high);
+        vTaskDelay(pdMS_TO_TICKS(1));
+        gpio_set_level(ph->panel_dev_config.reset_gpio_num, !ph->panel_dev_config.flags.reset_active_high);
+    }
+    else
+    {
+        // Software reset
+        if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_SWRESET, NULL, 0)) != ESP_OK)
+        {
+            log_e("Sending LCD_CMD_SWRESET failed");
+            return res;
+        }
+    }
+
+    // Commands are accepted 5ms after a reset but SLPOUT only after the reset delay, init waits for the remainder
+    ph->slpout_deadline_us = esp_timer_get_time() + ph->descriptor->reset_delay_ms * 1000;
+    vTaskDelay(pdMS_TO_TICKS(5));
+
+    if (ph->descriptor->quirks & DCS_QUIRK_INIT_IN_RESET)
+    {
+        lcd_wait_until(ph->slpout_deadline_us);
+        lcd_boot_profile_add(LCD_BOOT_PHASE_RESET, start_us);
+        return dcs_tx_init_sequence(ph);
+    }
+
+    lcd_boot_profile_add(LCD_BOOT_PHASE_RESET, start_us);
+    return ESP_OK;
+}
+
+esp_err_t dcs_init(esp_lcd_panel_t *panel)
+{
+    log_v("panel:0x%08x", panel);
+    if (panel == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    dcs_panel_t *ph = (dcs_panel_t *)panel;
+
+    // Controller window is reset
+    ph->caset_valid = false;
+    ph->raset_valid = false;
+
+    esp_err_t res;
+    if (ph->descriptor->quirks & DCS_QUIRK_SLPOUT_FIRST)
+    {
+        if ((res = dcs_tx_slpout(ph)) != ESP_OK)
+            return res;
+
+        return dcs_tx_init_sequence(ph);
+    }
+
+    // The registers are written in sleep mode, overlapping the reset to SLPOUT delay
+    if ((res = dcs_tx_init_sequence(ph)) != ESP_OK)
+        return res;
+
+    return dcs_tx_slpout(ph);
+}
+
+// Bits per pixel sent, RGB444 packs two pixels in three bytes and RGB666 is sent as three bytes per pixel
+static uint8_t dcs_bits_per_pixel(const dcs_panel_t *ph)
+{
+    return ph->panel_dev_config.bits_per_pixel == 12 ? 12 : ((ph->panel_dev_config.bits_per_pixel + 0x7) & ~0x7);
+}
+
+static esp_err_t dcs_set_window(dcs_panel_t *ph, int x_start, int y_start, int x_end, int y_end)
+{
+    // Correct for gap
+    x_start += ph->x_gap;
+    x_end += ph->x_gap;
+    y_start += ph->y_gap;
+    y_end += ph->y_gap;
+
+    esp_err_t res;
+    const uint8_t caset[4] = {x_start >> 8, x_start, (x_end - 1) >> 8, x_end - 1};
+    if (!ph->caset_valid || memcmp(ph->caset, caset, sizeof(caset)) != 0)
+    {
+        // Invalidate first, a failed transfer leaves the controller state unknown
+        ph->caset_valid = false;
+        if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_CASET, caset, sizeof(caset))) != ESP_OK)
+        {
+            log_e("Sending CASET failed");
+            return res;
+        }
+
+        memcpy(ph->caset, caset, sizeof(caset));
+        ph->caset_valid = true;
+    }
+
+    const uint8_t raset[4] = {y_start >> 8, y_start, (y_end - 1) >> 8, y_end - 1};
+    if (!(ph->descriptor->quirks & DCS_QUIRK_RAMWRC_CONTINUE) && (!ph->raset_valid || memcmp(ph->raset, raset, sizeof(raset)) != 0))
+    {
+        ph->raset_valid = false;
+        if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_RASET, raset, sizeof(raset))) != ESP_OK)
+        {
+            log_e("Sending RASET failed");
+            return res;
+        }
+
+        memcpy(ph->raset, raset, sizeof(raset));
+        ph->raset_valid = true;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t dcs_draw_window(dcs_panel_t *ph, int x_start, int y_start, int x_end, int y_end, const void *color_data)
+{
+    // Without RASET, a write not starting at the first row continues after the previous one
+    bool write_continue = (ph->descriptor->quirks & DCS_QUIRK_RAMWRC_CONTINUE) && y_start > 0;
+
+    esp_err_t res;
+    if ((res = dcs_set_window(ph, x_start, y_start, x_end, y_end)) != ESP_OK)
+        return res;
+
+    size_t len = ((x_end - x_start) * (y_end - y_start) * dcs_bits_per_pixel(ph) + 0x7) >> 3;
+    if ((res = esp_lcd_panel_io_tx_color(ph->panel_io_handle, write_continue ? LCD_CMD_RAMWRC : LCD_CMD_RAMWR, color_data, len)) != ESP_OK)
+    {
+        log_e("Sending RAMWR/RAMWRC failed");
+        return res;
+    }
+
+    return ESP_OK;
+}
+
+// Frame memory row of the display row y, rows is set to the number of consecutive rows up to y_end
+static int dcs_map_rows(const dcs_panel_t *ph, int y, int y_end, int *rows)
+{
+    int scroll_end = ph->scroll_y + ph->scroll_height;
+    if (ph->scroll_height == 0 || y >= scroll_end)
+    {
+        *rows = y_end - y;
+        return y;
+    }
+
+    if (y < ph->scroll_y)
+    {
+        *rows = MIN(y_end, ph->scroll_y) - y;
+        return y;
+    }
+
+    int position = (y - ph->scroll_y + ph->scroll_offset) % ph->scroll_height;
+    *rows = MIN(MIN(y_end, scroll_end) - y, ph->scroll_height - position);
+    return ph->scroll_y + position;
+}
+
+esp_err_t dcs_draw_bitmap(esp_lcd_panel_t *panel, int x_start, int y_start, int x_end, int y_end, const void *color_data)
+{
+    log_v("panel:0x%08x, x_start:%d, y_start:%d, x_end:%d, y_end:%d, color_data:0x%08x", panel, x_start, y_start, x_end, y_end, color_data);
+    if (panel == NULL || color_data == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    dcs_panel_t *ph = (dcs_panel_t *)panel;
+
+    if (x_start >= x_end)
+    {
+        log_w("X-start greater than the x-end");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (y_start >= y_end)
+    {
+        log_w("Y-start greater than the y-end");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (ph->scroll_height == 0)
+        return dcs_draw_window(ph, x_start, y_start, x_end, y_end, color_data);
+
+    // Rows in the scrolling area are written where they are displayed, the area wraps around
+    size_t row_bits = (x_end - x_start) * dcs_bits_per_pixel(ph);
+    const uint8_t *data = color_data;
+    esp_err_t res;
+    for (int y = y_start; y < y_end;)
+    {
+        int rows;
+        int y_mapped = dcs_map_rows(ph, y, y_end, &rows);
+        size_t offset_bits = (y - y_start) * row_bits;
+        if ((offset_bits & 0x7) != 0)
+        {
+            log_e("Split of the bitmap at row %d is not on a byte boundary", y);
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+
+        if ((res = dcs_draw_window(ph, x_start, y_mapped, x_end, y_mapped + rows, data + (offset_bits >> 3))) != ESP_OK)
+            return res;
+
+        y += rows;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t dcs_invert_color(esp_lcd_panel_t *panel, bool invert)
+{
+    log_v("panel:0x%08x, invert:%d", panel, invert);
+    if (panel == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    const dcs_panel_t *ph = (dcs_panel_t *)panel;
+
+    esp_err_t res;
+    if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, invert ? LCD_CMD_INVON : LCD_CMD_INVOFF, NULL, 0)) != ESP_OK)
+    {
+        log_e("Sending LCD_CMD_INVON/LCD_CMD_INVOFF failed");
+        return res;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t dcs_tx_scroll(dcs_panel_t *ph)
+{
+    // VSCRDEF and VSCRSADD use frame memory rows, these are in the opposite order of the display rows when mirrored in Y
+    int gram_lines = ph->descriptor->gram_lines;
+    int top, height, start;
+    if (ph->scroll_height == 0)
+    {
+        top = 0;
+        height = gram_lines;
+        start = 0;
+    }
+    else if (ph->madctl & LCD_CMD_MY_BIT)
+    {
+        height = ph->scroll_height;
+        top = gram_lines - (ph->scroll_y + ph->y_gap + height);
+        start = top + (height - ph->scroll_offset) % height;
+    }
+    else
+    {
+        height = ph->scroll_height;
+        top = ph->scroll_y + ph->y_gap;
+        start = top + ph->scroll_offset;
+    }
+
+    int bottom = gram_lines - top - height;
+    const uint8_t vscrdef[6] = {top >> 8, top, height >> 8, height, bottom >> 8, bottom};
+    const uint8_t vscsad[2] = {start >> 8, start};
+    esp_err_t res;
+    if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_VSCRDEF, vscrdef, sizeof(vscrdef))) != ESP_OK ||
+        (res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_VSCSAD, vscsad, sizeof(vscsad))) != ESP_OK)
+    {
+        log_e("Sending VSCRDEF/VSCRSADD failed");
+        return res;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t dcs_update_madctl(dcs_panel_t *ph)
+{
+    // Window coordinates are interpreted differently after a MADCTL change
+    ph->caset_valid = false;
+    ph->raset_valid = false;
+
+    esp_err_t res;
+    if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_MADCTL, &ph->madctl, 1)) != ESP_OK)
+    {
+        log_e("Sending LCD_CMD_MADCTL failed");
+        return res;
+    }
+
+    // Scrolling is defined in frame memory rows, it does not survive a change of the orientation
+    if (ph->scroll_height > 0)
+    {
+        ph->scroll_height = 0;
+        return dcs_tx_scroll(ph);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t dcs_mirror(esp_lcd_panel_t *panel, bool mirror_x, bool mirror_y)
+{
+    log_v("panel:0x%08x, mirror_x:%d, mirror_y:%d", panel, mirror_x, mirror_y);
+    if (panel == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    dcs_panel_t *ph = (dcs_panel_t *)panel;
+
+    if (mirror_x)
+        ph->madctl |= LCD_CMD_MX_BIT;
+    else
+        ph->madctl &= ~LCD_CMD_MX_BIT;
+
+    if (mirror_y)
+        ph->madctl |= LCD_CMD_MY_BIT;
+    else
+        ph->madctl &= ~LCD_CMD_MY_BIT;
+
+    return dcs_update_madctl(ph);
+}
+
+esp_err_t dcs_swap_xy(esp_lcd_panel_t *panel, bool swap_xy)
+{
+    log_v("panel:0x%08x, swap_xy:%d", panel, swap_xy);
+    if (panel == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    dcs_panel_t *ph = (dcs_panel_t *)panel;
+
+    if (swap_xy)
+        ph->madctl |= LCD_CMD_MV_BIT;
+    else
+        ph->madctl &= ~LCD_CMD_MV_BIT;
+
+    return dcs_update_madctl(ph);
+}
+
+esp_err_t dcs_set_gap(esp_lcd_panel_t *panel, int x_gap, int y_gap)
+{
+    log_v("panel:0x%08x, x_gap:%d, y_gap:%d", panel, x_gap, y_gap);
+    if (panel == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    dcs_panel_t *ph = (dcs_panel_t *)panel;
+
+    ph->x_gap = x_gap;
+    ph->y_gap = y_gap;
+    ph->caset_valid = false;
+    ph->raset_valid = false;
+
+    if (ph->scroll_height > 0)
+    {
+        ph->scroll_height = 0;
+        return dcs_tx_scroll(ph);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t dcs_disp_off(esp_lcd_panel_t *panel, bool off)
+{
+    log_v("panel:0x%08x, off:%d", panel, off);
+    if (panel == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    const dcs_panel_t *ph = (dcs_panel_t *)panel;
+
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t res;
+    if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, off ? LCD_CMD_DISPOFF : LCD_CMD_DISPON, NULL, 0)) != ESP_OK)
+    {
+        log_e("Sending LCD_CMD_DISPOFF/LCD_CMD_DISPON failed");
+        return res;
+    }
+
+    if (!off)
+        lcd_boot_profile_add(LCD_BOOT_PHASE_DISPON, start_us);
+
+    return ESP_OK;
+}
+
+esp_err_t dcs_del(esp_lcd_panel_t *panel)
+{
+    log_v("panel:0x%08x", panel);
+    if (panel == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    dcs_panel_t *ph = (dcs_panel_t *)panel;
+
+    // Reset RESET
+    if (ph->panel_dev_config.reset_gpio_num != GPIO_NUM_NC)
+        gpio_reset_pin(ph->panel_dev_config.reset_gpio_num);
+
+    free(ph);
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_new_panel_dcs(const dcs_panel_descriptor_t *descriptor, const esp_lcd_panel_io_handle_t panel_io_handle, const esp_lcd_panel_dev_config_t *panel_dev_config, esp_lcd_panel_handle_t *panel_handle)
+{
+    log_v("descriptor:0x%08x, panel_io_handle:0x%08x, panel_dev_config:0x%08x, panel_handle:0x%08x", descriptor, panel_io_handle, panel_dev_config, panel_handle);
+    if (descriptor == NULL || panel_io_handle == NULL || panel_dev_config == NULL || panel_handle == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    if (panel_dev_config->reset_gpio_num != GPIO_NUM_NC && !GPIO_IS_VALID_GPIO(panel_dev_config->reset_gpio_num))
+    {
+        log_e("Invalid GPIO RST pin: %d", panel_dev_config->reset_gpio_num);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t madctl;
+    switch (panel_dev_config->color_space)
+    {
+    case ESP_LCD_COLOR_SPACE_RGB:
+        madctl = 0;
+        break;
+    case ESP_LCD_COLOR_SPACE_BGR:
+        madctl = LCD_CMD_BGR_BIT;
+        break;
+    default:
+        log_e("Invalid color space: %d. Only RGB and BGR are supported", panel_dev_config->color_space);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t colmod;
+    switch (panel_dev_config->bits_per_pixel)
+    {
+    case 12: // RGB444
+        colmod = descriptor->colmod_rgb444;
+        break;
+    case 16: // RGB565
+        colmod = descriptor->colmod_rgb565;
+        break;
+    case 18: // RGB666
+        colmod = descriptor->colmod_rgb666;
+        break;
+    case 24: // RGB888
+        colmod = descriptor->colmod_rgb888;
+        break;
+    default:
+        colmod = 0;
+        break;
+    }
+
+    if (colmod == 0)
+    {
+        log_e("Invalid bits per pixel: %d. Not supported by the %s", panel_dev_config->bits_per_pixel, descriptor->name);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (panel_dev_config->reset_gpio_num != GPIO_NUM_NC)
+    {
+        esp_err_t res;
+        const gpio_config_t cfg = {
+            .pin_bit_mask = BIT64(panel_dev_config->reset_gpio_num),
+            .mode = GPIO_MODE_OUTPUT};
+        if ((res = gpio_config(&cfg)) != ESP_OK)
+        {
+            log_e("Configuring GPIO for RST failed");
+            return res;
+        }
+    }
+
+    dcs_panel_t *ph = heap_caps_calloc(1, sizeof(dcs_panel_t), MALLOC_CAP_DEFAULT);
+    if (ph == NULL)
+    {
+        log_e("No memory available for dcs_panel_t");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ph->descriptor = descriptor;
+    ph->panel_io_handle = panel_io_handle;
+    memcpy(&ph->panel_dev_config, panel_dev_config, sizeof(esp_lcd_panel_dev_config_t));
+    ph->madctl = madctl;
+    ph->colmod = colmod;
+
+    ph->base.del = dcs_del;
+    ph->base.reset = dcs_reset;
+    ph->base.init = dcs_init;
+    ph->base.draw_bitmap = dcs_draw_bitmap;
+    ph->base.invert_color = dcs_invert_color;
+    ph->base.mirror = dcs_mirror;
+    ph->base.swap_xy = dcs_swap_xy;
+    ph->base.set_gap = dcs_set_gap;
+    ph->base.disp_off = dcs_disp_off;
+
+    log_d("%s panel_handle: 0x%08x", descriptor->name, ph);
+    *panel_handle = (esp_lcd_panel_handle_t)ph;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_dcs_scroll(esp_lcd_panel_handle_t panel, int y, int height, int lines)
+{
+    log_v("panel:0x%08x, y:%d, height:%d, lines:%d", panel, y, height, lines);
+    if (panel == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    dcs_panel_t *ph = (dcs_panel_t *)panel;
+
+    if (ph->descriptor->gram_lines == 0)
+    {
+        log_w("Vertical scrolling is not supported by the %s", ph->descriptor->name);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (ph->madctl & LCD_CMD_MV_BIT)
+    {
+        log_w("Vertical scrolling is not supported with X and Y swapped");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (y < 0 || height < 0 || y + ph->y_gap + height > ph->descriptor->gram_lines)
+    {
+        log_w("Invalid scrolling area: y:%d, height:%d", y, height);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // A new area starts unscrolled
+    if (y != ph->scroll_y || height != ph->scroll_height)
+    {
+        ph->scroll_y = y;
+        ph->scroll_height = height;
+        ph->scroll_offset = 0;
+    }
+
+    if (height > 0)
+        ph->scroll_offset = ((ph->scroll_offset + lines) % height + height) % height;
+
+    return dcs_tx_scroll(ph);
+}
+
+esp_err_t esp_lcd_panel_dcs_set_frame_rate(esp_lcd_panel_handle_t panel, uint32_t hz)
+{
+    log_v("panel:0x%08x, hz:%d", panel, hz);
+    if (panel == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    const dcs_panel_t *ph = (dcs_panel_t *)panel;
+    const dcs_panel_descriptor_t *descriptor = ph->descriptor;
+
+    if (descriptor->frame_rates == NULL || descriptor->frame_rates_count == 0)
+    {
+        log_w("Frame rate control is not supported by the %s", descriptor->name);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (hz == 0)
+        hz = descriptor->frame_rate_hz;
+
+    const dcs_frame_rate_t *frame_rate = &descriptor->frame_rates[0];
+    for (size_t i = 1; i < descriptor->frame_rates_count; i++)
+        if (abs((int)descriptor->frame_rates[i].hz - (int)hz) < abs((int)frame_rate->hz - (int)hz))
+            frame_rate = &descriptor->frame_rates[i];
+
+    esp_err_t res;
+    if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, descriptor->frame_rate_cmd, frame_rate->params, descriptor->frame_rate_params_size)) != ESP_OK)
+    {
+        log_e("Sending frame rate control failed");
+        return res;
+    }
+
+    log_d("%s frame rate: %d Hz", descriptor->name, frame_rate->hz);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_dcs_set_idle_mode(esp_lcd_panel_handle_t panel, bool idle)
+{
+    log_v("panel:0x%08x, idle:%d", panel, idle);
+    if (panel == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    const dcs_panel_t *ph = (dcs_panel_t *)panel;
+
+    esp_err_t res;
+    if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, idle ? LCD_CMD_IDMON : LCD_CMD_IDMOFF, NULL, 0)) != ESP_OK)
+    {
+        log_e("Sending LCD_CMD_IDMON/LCD_CMD_IDMOFF failed");
+        return res;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_dcs_set_partial_area(esp_lcd_panel_handle_t panel, int y, int height)
+{
+    log_v("panel:0x%08x, y:%d, height:%d", panel, y, height);
+    if (panel == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    const dcs_panel_t *ph = (dcs_panel_t *)panel;
+
+    esp_err_t res;
+    if (height == 0)
+    {
+        if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_NORON, NULL, 0)) != ESP_OK)
+        {
+            log_e("Sending LCD_CMD_NORON failed");
+            return res;
+        }
+
+        return ESP_OK;
+    }
+
+    if (y < 0 || height < 0)
+    {
+        log_w("Invalid partial area: y:%d, height:%d", y, height);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (ph->madctl & LCD_CMD_MV_BIT)
+    {
+        log_w("Partial mode is not supported with X and Y swapped");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    // PTLAR uses frame memory rows, these are in the opposite order of the display rows when mirrored in Y
+    int start;
+    if (ph->madctl & LCD_CMD_MY_BIT)
+    {
+        if (ph->descriptor->gram_lines == 0)
+        {
+            log_w("Partial mode is not supported by the %s when mirrored in Y", ph->descriptor->name);
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+
+        start = ph->descriptor->gram_lines - (y + ph->y_gap + height);
+    }
+    else
+        start = y + ph->y_gap;
+
+    int end = start + height - 1;
+    const uint8_t ptlar[4] = {start >> 8, start, end >> 8, end};
+    if ((res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_PTLAR, ptlar, sizeof(ptlar))) != ESP_OK ||
+        (res = esp_lcd_panel_io_tx_param(ph->panel_io_handle, LCD_CMD_PTLON, NULL, 0)) != ESP_OK)
+    {
+        log_e("Sending PTLAR/PTLON failed");
+        return res;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_dcs_read_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end, uint16_t *rgb565)
+{
+    log_v("panel:0x%08x, x_start:%d, y_start:%d, x_end:%d, y_end:%d, rgb565:0x%08x", panel, x_start, y_start, x_end, y_end, rgb565);
+    if (panel == NULL || rgb565 == NULL || x_start >= x_end || y_start >= y_end)
+        return ESP_ERR_INVALID_ARG;
+
+    dcs_panel_t *ph = (dcs_panel_t *)panel;
+
+    if (!ph->descriptor->ramrd)
+    {
+        log_w("Reading the frame memory is not supported by the %s", ph->descriptor->name);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    // One row at a time keeps the receive buffer small, the dummy clocks are skipped after the transfer
+    const int width = x_end - x_start;
+    const uint8_t dummy_bytes = ph->descriptor->ramrd_dummy_bits >> 3;
+    const uint8_t dummy_shift = ph->descriptor->ramrd_dummy_bits & 0x7;
+    const size_t len = width * 3 + ((ph->descriptor->ramrd_dummy_bits + 0x7) >> 3);
+    uint8_t *buffer = heap_caps_malloc(len, MALLOC_CAP_DMA);
+    if (buffer == NULL)
+    {
+        log_e("No memory for the RAMRD buffer");
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t res = ESP_OK;
+    for (int y = y_start; y < y_end; y++)
+    {
+        int rows;
+        int y_mapped = dcs_map_rows(ph, y, y + 1, &rows);
+        if ((res = dcs_set_window(ph, x_start, y_mapped, x_end, y_mapped + 1)) != ESP_OK)
+            break;
+
+        if ((res = esp_lcd_panel_io_rx_param(ph->panel_io_handle, LCD_CMD_RAMRD, buffer, len)) != ESP_OK)
+        {
+            log_e("Receiving RAMRD failed");
+            break;
+        }
+
+        const uint8_t *src = buffer + dummy_bytes;
+        uint16_t *dest = rgb565 + (y - y_start) * width;
+        for (int x = 0; x < width; x++, src += 3)
+        {
+            uint8_t rgb[3];
+            for (int i = 0; i < 3; i++)
+                rgb[i] = dummy_shift == 0 ? src[i] : (src[i] << dummy_shift) | (src[i + 1] >> (8 - dummy_shift));
+
+            // RGB666 is in the upper bits of every byte
+            dest[x] = ((rgb[0] & 0xF8) << 8) | ((rgb[1] & 0xFC) << 3) | (rgb[2] >> 3);
+        }
+    }
+
+    heap_caps_free(buffer);
+    return res;
+}
+
+#endif
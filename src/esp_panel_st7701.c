@@ -10,6 +10,7 @@
 #include <esp_lcd_panel_interface.h>
 #include <esp_lcd_panel_io.h>
 #include <esp_lcd_panel_ops.h>
+#include <esp_timer.h>
 
 #define ST7701_CMD_CND2BKxSEL 0xFF
 
@@ -23,49 +24,50 @@ typedef struct
     esp_lcd_panel_t *lcd_panel;
 } st7701_panel_t;
 
-const lcd_init_cmd_t st7701_vendor_specific_init_default[] = {
-    {0xFF, (uint8_t[]){0x77, 0x01, 0x00, 0x00, 0x10}, 5, 0},
-    {0xC0, (uint8_t[]){0x3B, 0x00}, 2, 0},
-    {0xC1, (uint8_t[]){0x0D, 0x02}, 2, 0},
-    {0xC2, (uint8_t[]){0x31, 0x05}, 2, 0},
-    {0xCD, (uint8_t[]){0x00}, 1, 0},
+const uint8_t st7701_vendor_specific_init_default[] = {
+    0xFF, 5, 0x77, 0x01, 0x00, 0x00, 0x10,
+    0xC0, 2, 0x3B, 0x00,
+    0xC1, 2, 0x0D, 0x02,
+    0xC2, 2, 0x31, 0x05,
+    0xCD, 1, 0x00,
     // Positive Voltage Gamma Control
-    {0xB0, (uint8_t[]){0x00, 0x11, 0x18, 0x0E, 0x11, 0x06, 0x07, 0x08, 0x07, 0x22, 0x04, 0x12, 0x0F, 0xAA, 0x31, 0x18}, 16, 0},
+    0xB0, 16, 0x00, 0x11, 0x18, 0x0E, 0x11, 0x06, 0x07, 0x08, 0x07, 0x22, 0x04, 0x12, 0x0F, 0xAA, 0x31, 0x18,
     // Negative Voltage Gamma Control
-    {0xB1, (uint8_t[]){0x00, 0x11, 0x19, 0x0E, 0x12, 0x07, 0x08, 0x08, 0x08, 0x22, 0x04, 0x11, 0x11, 0xA9, 0x32, 0x18}, 16, 0},
+    0xB1, 16, 0x00, 0x11, 0x19, 0x0E, 0x12, 0x07, 0x08, 0x08, 0x08, 0x22, 0x04, 0x11, 0x11, 0xA9, 0x32, 0x18,
     // PAGE1
-    {0xFF, (uint8_t[]){0x77, 0x01, 0x00, 0x00, 0x11}, 5, 0},
-    {0xB0, (uint8_t[]){0x60}, 1, 0}, // Vop=4.7375v
-    {0xB1, (uint8_t[]){0x32}, 1, 0}, // VCOM=32
-    {0xB2, (uint8_t[]){0x07}, 1, 0}, // VGH=15v
-    {0xB3, (uint8_t[]){0x80}, 1, 0},
-    {0xB5, (uint8_t[]){0x49}, 1, 0}, // VGL=-10.17v
-    {0xB7, (uint8_t[]){0x85}, 1, 0},
-    {0xB8, (uint8_t[]){0x21}, 1, 0}, // AVDD=6.6 & AVCL=-4.6
-    {0xC1, (uint8_t[]){0x78}, 1, 0},
-    {0xC2, (uint8_t[]){0x78}, 1, 0},
-    {0xE0, (uint8_t[]){0x00, 0x1B, 0x02}, 3, 0},
-    {0xE1, (uint8_t[]){0x08, 0xA0, 0x00, 0x00, 0x07, 0xA0, 0x00, 0x00, 0x00, 0x44, 0x44}, 11, 0},
-    {0xE2, (uint8_t[]){0x11, 0x11, 0x44, 0x44, 0xED, 0xA0, 0x00, 0x00, 0xEC, 0xA0, 0x00, 0x00}, 12, 0},
-    {0xE3, (uint8_t[]){0x00, 0x00, 0x11, 0x11}, 4, 0},
-    {0xE4, (uint8_t[]){0x44, 0x44}, 2, 0},
-    {0xE5, (uint8_t[]){0x0A, 0xE9, 0xD8, 0xA0, 0x0C, 0xEB, 0xD8, 0xA0, 0x0E, 0xED, 0xD8, 0xA0, 0x10, 0xEF, 0xD8, 0xA0}, 16, 0},
-    {0xE6, (uint8_t[]){0x00, 0x00, 0x11, 0x11}, 4, 0},
-    {0xE7, (uint8_t[]){0x44, 0x44}, 2, 0},
-    {0xE8, (uint8_t[]){0x09, 0xE8, 0xD8, 0xA0, 0x0B, 0xEA, 0xD8, 0xA0, 0x0D, 0xEC, 0xD8, 0xA0, 0x0F, 0xEE, 0xD8, 0xA0}, 16, 0},
-    {0xEB, (uint8_t[]){0x02, 0x00, 0xE4, 0xE4, 0x88, 0x00, 0x40}, 7, 0},
-    {0xEC, (uint8_t[]){0x3C, 0x00}, 2, 0},
-    {0xED, (uint8_t[]){0xAB, 0x89, 0x76, 0x54, 0x02, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x20, 0x45, 0x67, 0x98, 0xBA}, 16, 0},
+    0xFF, 5, 0x77, 0x01, 0x00, 0x00, 0x11,
+    0xB0, 1, 0x60, // Vop=4.7375v
+    0xB1, 1, 0x32, // VCOM=32
+    0xB2, 1, 0x07, // VGH=15v
+    0xB3, 1, 0x80,
+    0xB5, 1, 0x49, // VGL=-10.17v
+    0xB7, 1, 0x85,
+    0xB8, 1, 0x21, // AVDD=6.6 & AVCL=-4.6
+    0xC1, 1, 0x78,
+    0xC2, 1, 0x78,
+    0xE0, 3, 0x00, 0x1B, 0x02,
+    0xE1, 11, 0x08, 0xA0, 0x00, 0x00, 0x07, 0xA0, 0x00, 0x00, 0x00, 0x44, 0x44,
+    0xE2, 12, 0x11, 0x11, 0x44, 0x44, 0xED, 0xA0, 0x00, 0x00, 0xEC, 0xA0, 0x00, 0x00,
+    0xE3, 4, 0x00, 0x00, 0x11, 0x11,
+    0xE4, 2, 0x44, 0x44,
+    0xE5, 16, 0x0A, 0xE9, 0xD8, 0xA0, 0x0C, 0xEB, 0xD8, 0xA0, 0x0E, 0xED, 0xD8, 0xA0, 0x10, 0xEF, 0xD8, 0xA0,
+    0xE6, 4, 0x00, 0x00, 0x11, 0x11,
+    0xE7, 2, 0x44, 0x44,
+    0xE8, 16, 0x09, 0xE8, 0xD8, 0xA0, 0x0B, 0xEA, 0xD8, 0xA0, 0x0D, 0xEC, 0xD8, 0xA0, 0x0F, 0xEE, 0xD8, 0xA0,
+    0xEB, 7, 0x02, 0x00, 0xE4, 0xE4, 0x88, 0x00, 0x40,
+    0xEC, 2, 0x3C, 0x00,
+    0xED, 16, 0xAB, 0x89, 0x76, 0x54, 0x02, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x20, 0x45, 0x67, 0x98, 0xBA,
     // VAP & VAN
-    {0xFF, (uint8_t[]){0x77, 0x01, 0x00, 0x00, 0x13}, 5, 0},
-    {0xE5, (uint8_t[]){0xE4}, 1, 0},
-    {0xFF, (uint8_t[]){0x77, 0x01, 0x00, 0x00, 0x00}, 5, 0},
+    0xFF, 5, 0x77, 0x01, 0x00, 0x00, 0x13,
+    0xE5, 1, 0xE4,
+    0xFF, 5, 0x77, 0x01, 0x00, 0x00, 0x00,
     // 0x70 RGB888, 0x60 RGB666, 0x50 RGB565
-    {0x3A, (uint8_t[]){0x60}, 1, 0},
+    0x3A, 1, 0x60,
     // Sleep Out
-    {0x11, NULL, 0, 120},
+    0x11, 0 | LCD_INIT_DELAY, 120,
     // Display On
-    {0x29, NULL, 0, 0}};
+    0x29, 0,
+};
 
 esp_err_t st7701_reset(esp_lcd_panel_t *panel)
 {
@@ -75,6 +77,7 @@ esp_err_t st7701_reset(esp_lcd_panel_t *panel)
 
     const st7701_panel_t *ph = (st7701_panel_t *)panel;
 
+    int64_t start_us = esp_timer_get_time();
     esp_err_t res;
 
     if (ph->panel_dev_config.reset_gpio_num != GPIO_NUM_NC)
@@ -102,6 +105,8 @@ esp_err_t st7701_reset(esp_lcd_panel_t *panel)
         return res;
     }
 
+    lcd_boot_profile_add(LCD_BOOT_PHASE_RESET, start_us);
+
     return ESP_OK;
 }
 
@@ -113,6 +118,7 @@ esp_err_t st7701_init(esp_lcd_panel_t *panel)
 
     const st7701_panel_t *ph = (st7701_panel_t *)panel;
 
+    int64_t start_us = esp_timer_get_time();
     esp_err_t res;
     const uint8_t bkxsel[] = {0x77, 0x01, 0x00, 0x00, 0x00};
     if ((res = esp_lcd_panel_io_tx_param(ph->io, ST7701_CMD_CND2BKxSEL, bkxsel, sizeof(bkxsel))) != ESP_OK)
@@ -147,25 +153,17 @@ esp_err_t st7701_init(esp_lcd_panel_t *panel)
         return res;
     }
 
-    const lcd_init_cmd_t *cmd = st7701_vendor_specific_init_default;
-    uint16_t cmds_size = sizeof(st7701_vendor_specific_init_default) / sizeof(lcd_init_cmd_t);
-    if (ph->panel_dev_config.vendor_config != NULL)
-    {
-        cmd = ((st7701_vendor_config_t *)ph->panel_dev_config.vendor_config)->init_cmds;
-        cmds_size = ((st7701_vendor_config_t *)ph->panel_dev_config.vendor_config)->init_cmds_size;
-    }
+    const st7701_vendor_config_t *vendor_config = ph->panel_dev_config.vendor_config;
+    if (vendor_config != NULL)
+        res = lcd_tx_init_cmds(ph->io, vendor_config->init_cmds, vendor_config->init_cmds_size);
+    else
+        res = lcd_tx_init_bytecode(ph->io, st7701_vendor_specific_init_default, sizeof(st7701_vendor_specific_init_default));
 
-    while (cmds_size-- > 0)
-    {
-        if ((res = esp_lcd_panel_io_tx_param(ph->io, cmd->cmd, cmd->data, cmd->bytes)) != ESP_OK)
-        {
-            log_e("Sending command: 0x%02x failed", cmd->cmd);
-            return res;
-        }
+    if (res != ESP_OK)
+        return res;
 
-        vTaskDelay(pdMS_TO_TICKS(cmd->delay_ms));
-        cmd++;
-    }
+    // The vendor table includes SLPOUT and DISPON
+    lcd_boot_profile_add(LCD_BOOT_PHASE_INIT_TABLE, start_us);
 
     if ((res = esp_lcd_panel_init(ph->lcd_panel)) != ESP_OK)
     {
@@ -243,6 +241,18 @@ esp_err_t st7701_del(esp_lcd_panel_t *panel)
     return ESP_OK;
 }
 
+esp_err_t esp_lcd_st7701_get_rgb_panel(esp_lcd_panel_handle_t panel, esp_lcd_panel_handle_t *rgb_panel)
+{
+    log_v("panel:0x%08x, rgb_panel:0x%08x", panel, rgb_panel);
+    if (panel == NULL || rgb_panel == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    const st7701_panel_t *ph = (st7701_panel_t *)panel;
+    *rgb_panel = ph->lcd_panel;
+
+    return ESP_OK;
+}
+
 esp_err_t esp_lcd_new_panel_st7701(const esp_lcd_panel_io_handle_t io, const esp_lcd_rgb_panel_config_t *rgb_panel_config, const esp_lcd_panel_dev_config_t *panel_dev_config, esp_lcd_panel_handle_t *panel_handle)
 {
     log_v("panel_io_handle:0x%08x, rgb_panel_config:0x%08x, panel_dev_config:0x%08x, panel_handle:0x%08x", io, rgb_panel_config, panel_dev_config, panel_handle);
@@ -0,0 +1,48 @@
+#ifdef DISPLAY_ST7789_SPI
+
+#include <esp_panel_st7789.h>
+
+static const uint8_t st7789_vendor_specific_init_default[] = {
+    // RAM control, RAM access from MCU interface, RGB565 big endian
+    0xB0, 2, 0x00, 0xF0,
+};
+
+static const dcs_frame_rate_t st7789_frame_rates[] = {
+    // RTNA (clocks per line)
+    {119, {0x00}},
+    {99, {0x03}},
+    {90, {0x05}},
+    {78, {0x08}},
+    {69, {0x0B}},
+    {60, {0x0F}},
+    {50, {0x15}},
+    {45, {0x19}},
+    {39, {0x1F}},
+};
+
+static const dcs_panel_descriptor_t st7789_descriptor = {
+    .name = "ST7789",
+    .init_bytecode = st7789_vendor_specific_init_default,
+    .init_bytecode_size = sizeof(st7789_vendor_specific_init_default),
+    .colmod_rgb444 = 0x53,
+    .colmod_rgb565 = 0x55,
+    .colmod_rgb666 = 0x66,
+    .colmod_rgb888 = 0,
+    .gram_lines = 320,
+    .ramrd = true,
+    .ramrd_dummy_bits = 1, // A single dummy clock on the serial interface
+    .frame_rate_cmd = 0xC6,
+    .frame_rate_params_size = 1,
+    .frame_rates = st7789_frame_rates,
+    .frame_rates_count = sizeof(st7789_frame_rates) / sizeof(dcs_frame_rate_t),
+    .frame_rate_hz = 60,
+    .reset_delay_ms = 120,
+    .slpout_delay_ms = 5,
+    .quirks = 0};
+
+esp_err_t esp_lcd_new_panel_st7789_dcs(const esp_lcd_panel_io_handle_t panel_io_handle, const esp_lcd_panel_dev_config_t *panel_dev_config, esp_lcd_panel_handle_t *panel_handle)
+{
+    return esp_lcd_new_panel_dcs(&st7789_descriptor, panel_io_handle, panel_dev_config, panel_handle);
+}
+
+#endif
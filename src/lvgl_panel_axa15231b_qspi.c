@@ -18,23 +18,61 @@ bool axs15231b_color_trans_done(esp_lcd_panel_io_handle_t panel_io_handle, esp_l
     return false;
 }
 
+#if AXS15231B_SPI_CONFIG_FLAGS_QUAD_MODE
+#ifdef SMARTDISPLAY_SHADOW_FRAMEBUFFER
+#error "SMARTDISPLAY_SHADOW_FRAMEBUFFER is not supported by the AXS15231B in QSPI mode"
+#endif
+
+// RASET is ignored in QSPI mode: rows are written top down, RAMWR from the first row, RAMWRC after the previous write.
+// All invalidated areas of a frame start at the same row, so LVGL joins them into one contiguous area.
+static int32_t axs15231b_next_row;   // Row after the last written row
+static int32_t axs15231b_frame_row;  // First row of the frame being invalidated
+static bool axs15231b_frame_started;
+
+void axs15231b_invalidate_area(lv_event_t *e)
+{
+    lv_display_t *display = lv_event_get_target(e);
+    lv_area_t *area = lv_event_get_param(e);
+    area->x1 = 0;
+    area->x2 = lv_display_get_horizontal_resolution(display) - 1;
+
+    if (!axs15231b_frame_started)
+    {
+        // Continue after the last written row if possible, otherwise restart from the first row
+        axs15231b_frame_row = area->y1 >= axs15231b_next_row ? axs15231b_next_row : 0;
+        axs15231b_frame_started = true;
+    }
+    else if (area->y1 < axs15231b_frame_row)
+    {
+        // Restart from the first row, overlap the areas already invalidated so they are joined
+        area->y2 = LV_MAX(area->y2, axs15231b_frame_row);
+        axs15231b_frame_row = 0;
+    }
+
+    area->y1 = axs15231b_frame_row;
+}
+#endif
+
 void axs15231b_lv_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
 {
     // Hardware rotation is supported - use optimized helper function
     log_v("display:0x%08x, area:%0x%08x, color_map:0x%08x", display, area, px_map);
 
     esp_lcd_panel_handle_t panel_handle = display->user_data;
+#if AXS15231B_SPI_CONFIG_FLAGS_QUAD_MODE
+    axs15231b_next_row = area->y2 + 1;
+    if (lv_display_flush_is_last(display))
+        axs15231b_frame_started = false;
+#endif
     smartdisplay_dma_flush_with_byteswap(display, area, px_map, panel_handle, "AXS15231B QSPI");
 }
 
-lv_display_t *lvgl_lcd_init()
+lv_display_t *lvgl_lcd_init(const smartdisplay_config_t *config)
 {
     lv_display_t *display = lv_display_create(DISPLAY_WIDTH, DISPLAY_HEIGHT);
     log_v("display:0x%08x", display);
-    //  Create drawBuffer
-    uint32_t drawBufferSize = sizeof(lv_color_t) * LVGL_BUFFER_PIXELS;
-    void *drawBuffer = heap_caps_malloc(drawBufferSize, LVGL_BUFFER_MALLOC_FLAGS);
-    lv_display_set_buffers(display, drawBuffer, NULL, drawBufferSize, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    //  Create drawBuffer(s)
+    smartdisplay_lcd_set_buffers(display, config);
 
     // Create QSPI bus
     const spi_bus_config_t spi_bus_config = {
@@ -49,44 +87,48 @@ lv_display_t *lvgl_lcd_init()
     log_d("spi_bus_config: sclk_io_num:%d, data0_io_num:%d, data1_io_num:%d, data2_io_num:%d, data3_io_num:%d, max_transfer_sz:%d, flags:0x%08x, intr_flags:0x%04x", spi_bus_config.sclk_io_num, spi_bus_config.data0_io_num, spi_bus_config.data1_io_num, spi_bus_config.data2_io_num, spi_bus_config.data3_io_num, spi_bus_config.max_transfer_sz, spi_bus_config.flags, spi_bus_config.intr_flags);
     ESP_ERROR_CHECK_WITHOUT_ABORT(spi_bus_initialize(AXS15231B_SPI_HOST, &spi_bus_config, AXS15231B_SPI_DMA_CHANNEL));
 
-    // Attach the LCD controller to the SPI bus
+#if AXS15231B_SPI_CONFIG_FLAGS_QUAD_MODE
+    // Attach the LCD controller to the QSPI bus, the 32 bit command phase carries the opcode and DCS command
     const esp_lcd_panel_io_spi_config_t io_spi_config = {
         .cs_gpio_num = AXS15231B_SPI_CONFIG_CS,
         .dc_gpio_num = AXS15231B_SPI_CONFIG_DC,
-        .spi_mode = SPI_MODE0, // AXS15231B_SPI_CONFIG_SPI_MODE - QSPI not yet supported
+        .spi_mode = AXS15231B_SPI_CONFIG_SPI_MODE,
         .pclk_hz = AXS15231B_SPI_CONFIG_PCLK_HZ,
         .trans_queue_depth = AXS15231B_SPI_CONFIG_TRANS_QUEUE_DEPTH,
         .user_ctx = display,
         .on_color_trans_done = axs15231b_color_trans_done,
-        .lcd_cmd_bits = 8, // AXS15231B_SPI_CONFIG_LCD_CMD_BITS - QSPI not yet supported
+        .lcd_cmd_bits = 32,
+        .lcd_param_bits = AXS15231B_SPI_CONFIG_LCD_PARAM_BITS,
+        .flags = {
+            .dc_low_on_data = AXS15231B_SPI_CONFIG_FLAGS_DC_LOW_ON_DATA,
+            .octal_mode = AXS15231B_SPI_CONFIG_FLAGS_OCTAL_MODE,
+            .quad_mode = true,
+            .lsb_first = AXS15231B_SPI_CONFIG_FLAGS_LSB_FIRST}};
+    log_d("io_spi_config: cs_gpio_num:%d, dc_gpio_num:%d, spi_mode:%d, pclk_hz:%d, trans_queue_depth:%d, user_ctx:0x%08x, on_color_trans_done:0x%08x, lcd_cmd_bits:%d, lcd_param_bits:%d, flags:{dc_low_on_data:%d, octal_mode:%d, quad_mode:%d, lsb_first:%d}", io_spi_config.cs_gpio_num, io_spi_config.dc_gpio_num, io_spi_config.spi_mode, io_spi_config.pclk_hz, io_spi_config.trans_queue_depth, io_spi_config.user_ctx, io_spi_config.on_color_trans_done, io_spi_config.lcd_cmd_bits, io_spi_config.lcd_param_bits, io_spi_config.flags.dc_low_on_data, io_spi_config.flags.octal_mode, io_spi_config.flags.quad_mode, io_spi_config.flags.lsb_first);
+    esp_lcd_panel_io_handle_t spi_io_handle;
+    ESP_ERROR_CHECK(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)AXS15231B_SPI_HOST, &io_spi_config, &spi_io_handle));
+    esp_lcd_panel_io_handle_t io_handle;
+    ESP_ERROR_CHECK(esp_lcd_new_panel_io_axs15231b_qspi(spi_io_handle, &io_handle));
+#else
+    // Attach the LCD controller to the SPI bus (single data line)
+    const esp_lcd_panel_io_spi_config_t io_spi_config = {
+        .cs_gpio_num = AXS15231B_SPI_CONFIG_CS,
+        .dc_gpio_num = AXS15231B_SPI_CONFIG_DC,
+        .spi_mode = SPI_MODE0,
+        .pclk_hz = AXS15231B_SPI_CONFIG_PCLK_HZ,
+        .trans_queue_depth = AXS15231B_SPI_CONFIG_TRANS_QUEUE_DEPTH,
+        .user_ctx = display,
+        .on_color_trans_done = axs15231b_color_trans_done,
+        .lcd_cmd_bits = 8,
         .lcd_param_bits = AXS15231B_SPI_CONFIG_LCD_PARAM_BITS,
         .flags = {
             .dc_low_on_data = AXS15231B_SPI_CONFIG_FLAGS_DC_LOW_ON_DATA,
             .octal_mode = AXS15231B_SPI_CONFIG_FLAGS_OCTAL_MODE,
             .lsb_first = AXS15231B_SPI_CONFIG_FLAGS_LSB_FIRST}};
     log_d("io_spi_config: cs_gpio_num:%d, dc_gpio_num:%d, spi_mode:%d, pclk_hz:%d, trans_queue_depth:%d, user_ctx:0x%08x, on_color_trans_done:0x%08x, lcd_cmd_bits:%d, lcd_param_bits:%d, flags:{dc_low_on_data:%d, octal_mode:%d, lsb_first:%d}", io_spi_config.cs_gpio_num, io_spi_config.dc_gpio_num, io_spi_config.spi_mode, io_spi_config.pclk_hz, io_spi_config.trans_queue_depth, io_spi_config.user_ctx, io_spi_config.on_color_trans_done, io_spi_config.lcd_cmd_bits, io_spi_config.lcd_param_bits, io_spi_config.flags.dc_low_on_data, io_spi_config.flags.octal_mode, io_spi_config.flags.lsb_first);
-
-    // Attach the LCD controller to the QSPI bus
-    // const esp_lcd_panel_io_spi_config_t io_spi_config = {
-    //     .cs_gpio_num = AXS15231B_SPI_CONFIG_CS,
-    //     .dc_gpio_num = AXS15231B_SPI_CONFIG_DC,
-    //     .spi_mode = AXS15231B_SPI_CONFIG_SPI_MODE,
-    //     .pclk_hz = AXS15231B_SPI_CONFIG_PCLK_HZ,
-    //     .trans_queue_depth = AXS15231B_SPI_CONFIG_TRANS_QUEUE_DEPTH,
-    //     .user_ctx = display,
-    //     .on_color_trans_done = axs15231b_color_trans_done,
-    //     .lcd_cmd_bits = AXS15231B_SPI_CONFIG_LCD_CMD_BITS,
-    //     .lcd_param_bits = AXS15231B_SPI_CONFIG_LCD_PARAM_BITS,
-    //     .flags = {
-    //         .dc_low_on_data = AXS15231B_SPI_CONFIG_FLAGS_DC_LOW_ON_DATA,
-    //         .octal_mode = AXS15231B_SPI_CONFIG_FLAGS_OCTAL_MODE,
-    //         .quad_mode = AXS15231B_SPI_CONFIG_FLAGS_QUAD_MODE,
-    //         .sio_mode = AXS15231B_SPI_CONFIG_FLAGS_SIO_MODE,
-    //         .lsb_first = AXS15231B_SPI_CONFIG_FLAGS_LSB_FIRST}};
-    // //log_d("io_spi_config: cs_gpio_num:%d, dc_gpio_num:%d, spi_mode:%d, pclk_hz:%d, trans_queue_depth:%d, user_ctx:0x%08x, on_color_trans_done:0x%08x, lcd_cmd_bits:%d, lcd_param_bits:%d, flags:{dc_low_on_data:%d, octal_mode:%d, quad_mode:%d, sio_mode:%d, lsb_first:%d}", io_spi_config.cs_gpio_num, io_spi_config.dc_gpio_num, io_spi_config.spi_mode, io_spi_config.pclk_hz, io_spi_config.trans_queue_depth, io_spi_config.user_ctx, io_spi_config.on_color_trans_done, io_spi_config.lcd_cmd_bits, io_spi_config.lcd_param_bits, io_spi_config.flags.dc_low_on_data, io_spi_config.flags.octal_mode, io_spi_config.quad_mode, io_spi_config.sio_mode, io_spi_config.flags.lsb_first);
-    
     esp_lcd_panel_io_handle_t io_handle;
     ESP_ERROR_CHECK(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)AXS15231B_SPI_HOST, &io_spi_config, &io_handle));
+#endif
 
     // Create axs15231b panel handle
     const esp_lcd_panel_dev_config_t panel_dev_config = {
@@ -98,12 +140,16 @@ lv_display_t *lvgl_lcd_init()
         .vendor_config = AXS15231B_DEV_CONFIG_VENDOR_CONFIG};
     log_d("panel_dev_config: reset_gpio_num:%d, color_space:%d, bits_per_pixel:%d, flags:{reset_active_high:%d}, vendor_config: 0x%08x", panel_dev_config.reset_gpio_num, panel_dev_config.color_space, panel_dev_config.bits_per_pixel, panel_dev_config.flags.reset_active_high, panel_dev_config.vendor_config);
     esp_lcd_panel_handle_t panel_handle;
+#if AXS15231B_SPI_CONFIG_FLAGS_QUAD_MODE
+    ESP_ERROR_CHECK(esp_lcd_new_panel_axs15231b_qspi(io_handle, &panel_dev_config, &panel_handle));
+#else
     ESP_ERROR_CHECK(esp_lcd_new_panel_axs15231b(io_handle, &panel_dev_config, &panel_handle));
+#endif
     ESP_ERROR_CHECK(esp_lcd_panel_reset(panel_handle));
     ESP_ERROR_CHECK(esp_lcd_panel_init(panel_handle));
     
     // Initialize DMA for optimized transfers
-    smartdisplay_dma_init_with_logging(panel_handle, "AXS15231B QSPI");
+    smartdisplay_dma_init_with_logging(panel_handle, "AXS15231B QSPI", SMARTDISPLAY_DMA_BOARD_TE_SYNC);
     
 #ifdef DISPLAY_IPS
     // If LCD is IPS invert the colors
@@ -120,9 +166,16 @@ lv_display_t *lvgl_lcd_init()
 #endif
     // Turn display on
     ESP_ERROR_CHECK(esp_lcd_panel_disp_on_off(panel_handle, true));
+#ifdef DISPLAY_TE
+    // Synchronize the transfers to the refresh of the panel
+    ESP_ERROR_CHECK(lcd_te_enable(io_handle, DISPLAY_TE));
+#endif
 
     display->user_data = panel_handle;
     display->flush_cb = axs15231b_lv_flush;
+#if AXS15231B_SPI_CONFIG_FLAGS_QUAD_MODE
+    lv_display_add_event_cb(display, axs15231b_invalidate_area, LV_EVENT_INVALIDATE_AREA, NULL);
+#endif
 
     return display;
 }
@@ -22,14 +22,12 @@ void ili9341_lv_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_
     smartdisplay_dma_flush_with_byteswap(display, area, px_map, panel_handle, "ILI9341 SPI");
 };
 
-lv_display_t *lvgl_lcd_init()
+lv_display_t *lvgl_lcd_init(const smartdisplay_config_t *config)
 {
     lv_display_t *display = lv_display_create(DISPLAY_WIDTH, DISPLAY_HEIGHT);
     log_v("display:0x%08x", display);
-    //  Create drawBuffer
-    uint32_t drawBufferSize = sizeof(lv_color_t) * LVGL_BUFFER_PIXELS;
-    void *drawBuffer = heap_caps_malloc(drawBufferSize, LVGL_BUFFER_MALLOC_FLAGS);
-    lv_display_set_buffers(display, drawBuffer, NULL, drawBufferSize, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    //  Create drawBuffer(s)
+    smartdisplay_lcd_set_buffers(display, config);
 
     // Create SPI bus
     const spi_bus_config_t spi_bus_config = {
@@ -78,7 +76,7 @@ lv_display_t *lvgl_lcd_init()
     ESP_ERROR_CHECK(esp_lcd_panel_init(panel_handle));
     
     // Initialize DMA for optimized transfers
-    smartdisplay_dma_init_with_logging(panel_handle, "ILI9341 SPI");
+    smartdisplay_dma_init_with_logging(panel_handle, "ILI9341 SPI", SMARTDISPLAY_DMA_BOARD_TE_SYNC);
     
 #ifdef DISPLAY_IPS
     // If LCD is IPS invert the colors
@@ -95,6 +93,10 @@ lv_display_t *lvgl_lcd_init()
 #endif
     // Turn display on
     ESP_ERROR_CHECK(esp_lcd_panel_disp_on_off(panel_handle, true));
+#ifdef DISPLAY_TE
+    // Synchronize the transfers to the refresh of the panel
+    ESP_ERROR_CHECK(lcd_te_enable(io_handle, DISPLAY_TE));
+#endif
 
     display->user_data = panel_handle;
     display->flush_cb = ili9341_lv_flush;
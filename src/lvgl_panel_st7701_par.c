@@ -6,13 +6,11 @@
 #include <esp_lcd_panel_rgb.h>
 #include <esp_lcd_panel_ops.h>
 #include <esp32_smartdisplay_dma_helpers.h>
+#include <esp32_smartdisplay_rgb.h>
 
 bool direct_io_frame_trans_done(esp_lcd_panel_handle_t panel, esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
 {
-    // Note: When using DMA, lv_display_flush_ready() is called by DMA callbacks
-    // This callback is only used for direct transfers (non-DMA fallback)
-    // We return false to indicate we're not handling the flush completion here
-    return false;
+    return smartdisplay_rgb_frame_done(panel, edata, user_ctx);
 }
 
 void direct_io_lv_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
@@ -22,14 +20,14 @@ void direct_io_lv_flush(lv_display_t *display, const lv_area_t *area, uint8_t *p
     smartdisplay_dma_flush_with_rotation(display, area, px_map, panel_handle, "ST7701 Parallel");
 };
 
-lv_display_t *lvgl_lcd_init()
+lv_display_t *lvgl_lcd_init(const smartdisplay_config_t *config)
 {
     lv_display_t *display = lv_display_create(DISPLAY_WIDTH, DISPLAY_HEIGHT);
     log_v("display:0x%08x", display);
-    //  Create drawBuffer
-    uint32_t drawBufferSize = sizeof(lv_color_t) * LVGL_BUFFER_PIXELS;
-    void *drawBuffer = heap_caps_malloc(drawBufferSize, LVGL_BUFFER_MALLOC_FLAGS);
-    lv_display_set_buffers(display, drawBuffer, NULL, drawBufferSize, LV_DISPLAY_RENDER_MODE_PARTIAL);
+#ifndef SMARTDISPLAY_RGB_DIRECT_MODE
+    //  Create drawBuffer(s)
+    smartdisplay_lcd_set_buffers(display, config);
+#endif
 
     // Install 3-wire SPI panel IO
     esp_lcd_panel_io_3wire_spi_config_t io_3wire_spi_config = {
@@ -77,9 +75,25 @@ lv_display_t *lvgl_lcd_init()
         .pclk_gpio_num = ST7701_PANEL_CONFIG_PCLK,
         .data_gpio_nums = {ST7701_PANEL_CONFIG_DATA_R0, ST7701_PANEL_CONFIG_DATA_R1, ST7701_PANEL_CONFIG_DATA_R2, ST7701_PANEL_CONFIG_DATA_R3, ST7701_PANEL_CONFIG_DATA_R4, ST7701_PANEL_CONFIG_DATA_G0, ST7701_PANEL_CONFIG_DATA_G1, ST7701_PANEL_CONFIG_DATA_G2, ST7701_PANEL_CONFIG_DATA_G3, ST7701_PANEL_CONFIG_DATA_G4, ST7701_PANEL_CONFIG_DATA_G5, ST7701_PANEL_CONFIG_DATA_B0, ST7701_PANEL_CONFIG_DATA_B1, ST7701_PANEL_CONFIG_DATA_B2, ST7701_PANEL_CONFIG_DATA_B3, ST7701_PANEL_CONFIG_DATA_B4},
         .disp_gpio_num = ST7701_PANEL_CONFIG_DISP,
+#ifdef SMARTDISPLAY_RGB_BOUNCE_BUFFER_LINES
+        // Bounce buffers in internal memory, filled by the CPU from the framebuffer in PSRAM
+        .bounce_buffer_size_px = ST7701_PANEL_CONFIG_TIMINGS_H_RES * SMARTDISPLAY_RGB_BOUNCE_BUFFER_LINES,
+#endif
+#ifdef SMARTDISPLAY_RGB_DIRECT_MODE
+        // Two framebuffers, used as LVGL direct mode buffers
+        .num_fbs = 2,
+#endif
         .on_frame_trans_done = direct_io_frame_trans_done,
         .user_ctx = display,
-        .flags = {.disp_active_low = ST7701_PANEL_CONFIG_FLAGS_DISP_ACTIVE_LOW, .relax_on_idle = ST7701_PANEL_CONFIG_FLAGS_RELAX_ON_IDLE, .fb_in_psram = ST7701_PANEL_CONFIG_FLAGS_FB_IN_PSRAM}};
+        .flags = {
+            .disp_active_low = ST7701_PANEL_CONFIG_FLAGS_DISP_ACTIVE_LOW,
+            .relax_on_idle = ST7701_PANEL_CONFIG_FLAGS_RELAX_ON_IDLE,
+            .fb_in_psram = ST7701_PANEL_CONFIG_FLAGS_FB_IN_PSRAM,
+#ifdef SMARTDISPLAY_RGB_REFRESH_ON_DEMAND
+            // Only scan out a frame when new content has been transferred
+            .refresh_on_demand = true,
+#endif
+        }};
     log_d("rgb_panel_config: clk_src:%d, timings:{pclk_hz:%d, h_res:%d, v_res:%d, hsync_pulse_width:%d, hsync_back_porch:%d, hsync_front_porch:%d, vsync_pulse_width:%d, vsync_back_porch:%d, vsync_front_porch:%d, flags:{hsync_idle_low:%d, vsync_idle_low:%d, de_idle_high:%d, pclk_active_neg:%d, pclk_idle_high:%d}}, data_width:%d, sram_trans_align:%d, psram_trans_align:%d, hsync_gpio_num:%d, vsync_gpio_num:%d, de_gpio_num:%d, pclk_gpio_num:%d, data_gpio_nums:[%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d], disp_gpio_num:%d, on_frame_trans_done:0x%08x, user_ctx:0x%08x, flags:{disp_active_low:%d, relax_on_idle:%d, fb_in_psram:%d}", rgb_panel_config.clk_src, rgb_panel_config.timings.pclk_hz, rgb_panel_config.timings.h_res, rgb_panel_config.timings.v_res, rgb_panel_config.timings.hsync_pulse_width, rgb_panel_config.timings.hsync_back_porch, rgb_panel_config.timings.hsync_front_porch, rgb_panel_config.timings.vsync_pulse_width, rgb_panel_config.timings.vsync_back_porch, rgb_panel_config.timings.vsync_front_porch, rgb_panel_config.timings.flags.hsync_idle_low, rgb_panel_config.timings.flags.vsync_idle_low, rgb_panel_config.timings.flags.de_idle_high, rgb_panel_config.timings.flags.pclk_active_neg, rgb_panel_config.timings.flags.pclk_idle_high, rgb_panel_config.data_width, rgb_panel_config.sram_trans_align, rgb_panel_config.psram_trans_align, rgb_panel_config.hsync_gpio_num, rgb_panel_config.vsync_gpio_num, rgb_panel_config.de_gpio_num, rgb_panel_config.pclk_gpio_num, rgb_panel_config.data_gpio_nums[0], rgb_panel_config.data_gpio_nums[1], rgb_panel_config.data_gpio_nums[2], rgb_panel_config.data_gpio_nums[3], rgb_panel_config.data_gpio_nums[4], rgb_panel_config.data_gpio_nums[5], rgb_panel_config.data_gpio_nums[6], rgb_panel_config.data_gpio_nums[7], rgb_panel_config.data_gpio_nums[8], rgb_panel_config.data_gpio_nums[9], rgb_panel_config.data_gpio_nums[10], rgb_panel_config.data_gpio_nums[11], rgb_panel_config.data_gpio_nums[12], rgb_panel_config.data_gpio_nums[13], rgb_panel_config.data_gpio_nums[14], rgb_panel_config.data_gpio_nums[15], rgb_panel_config.disp_gpio_num, rgb_panel_config.on_frame_trans_done, rgb_panel_config.user_ctx, rgb_panel_config.flags.disp_active_low, rgb_panel_config.flags.relax_on_idle, rgb_panel_config.flags.fb_in_psram);
     log_d("refresh rate: %d Hz", (ST7701_PANEL_CONFIG_TIMINGS_PCLK_HZ * ST7701_PANEL_CONFIG_DATA_WIDTH) / (ST7701_PANEL_CONFIG_TIMINGS_H_RES + ST7701_PANEL_CONFIG_TIMINGS_HSYNC_PULSE_WIDTH + ST7701_PANEL_CONFIG_TIMINGS_HSYNC_BACK_PORCH + ST7701_PANEL_CONFIG_TIMINGS_HSYNC_FRONT_PORCH) / (ST7701_PANEL_CONFIG_TIMINGS_V_RES + ST7701_PANEL_CONFIG_TIMINGS_VSYNC_PULSE_WIDTH + ST7701_PANEL_CONFIG_TIMINGS_VSYNC_BACK_PORCH + ST7701_PANEL_CONFIG_TIMINGS_VSYNC_FRONT_PORCH) / SOC_LCD_RGB_DATA_WIDTH);
     const esp_lcd_panel_dev_config_t panel_dev_config = {
@@ -94,10 +108,22 @@ lv_display_t *lvgl_lcd_init()
     ESP_ERROR_CHECK(esp_lcd_new_panel_st7701(io_handle, &rgb_panel_config, &panel_dev_config, &panel_handle));
     ESP_ERROR_CHECK(esp_lcd_panel_reset(panel_handle));
     ESP_ERROR_CHECK(esp_lcd_panel_init(panel_handle));
+    // The few commands after the init sequence are bit-banged, the SPI host is free for other devices
+    ESP_ERROR_CHECK_WITHOUT_ABORT(esp_lcd_panel_io_3wire_spi_release_bus(io_handle));
+    esp_lcd_panel_handle_t rgb_panel_handle;
+    ESP_ERROR_CHECK(esp_lcd_st7701_get_rgb_panel(panel_handle, &rgb_panel_handle));
+    ESP_ERROR_CHECK(smartdisplay_rgb_init(display, rgb_panel_handle, &rgb_panel_config));
     
+#ifdef SMARTDISPLAY_RGB_DIRECT_MODE
+    // Render directly into the panel framebuffers, no DMA manager needed
+    ESP_ERROR_CHECK(smartdisplay_rgb_direct_mode_init(display));
+#elif defined(SMARTDISPLAY_RGB_BLIT)
+    // Flushes are written straight into the framebuffer, no DMA manager needed
+#else
     // Initialize DMA for optimized transfers
-    smartdisplay_dma_init_with_logging(panel_handle, "ST7701 Parallel");
-    
+    smartdisplay_dma_init_with_logging(panel_handle, "ST7701 Parallel", false);
+#endif
+
 #ifdef DISPLAY_IPS
     // If LCD is IPS invert the colors
     ESP_ERROR_CHECK(esp_lcd_panel_invert_color(panel_handle, true));
@@ -106,7 +132,11 @@ lv_display_t *lvgl_lcd_init()
     ESP_ERROR_CHECK(esp_lcd_panel_set_gap(panel_handle, DISPLAY_GAP_X, DISPLAY_GAP_Y));
 #endif
     display->user_data = panel_handle;
+#if defined(SMARTDISPLAY_RGB_BLIT) && !defined(SMARTDISPLAY_RGB_DIRECT_MODE)
+    display->flush_cb = smartdisplay_rgb_blit_flush;
+#elif !defined(SMARTDISPLAY_RGB_DIRECT_MODE)
     display->flush_cb = direct_io_lv_flush;
+#endif
 
     return display;
 }
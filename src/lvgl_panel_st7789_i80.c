@@ -4,41 +4,75 @@
 #include <esp_lcd_panel_io.h>
 #include <esp_lcd_panel_vendor.h>
 #include <esp_lcd_panel_ops.h>
+#include <esp_lcd.h>
 #include <esp32_smartdisplay_dma_helpers.h>
+#include <driver/gpio.h>
+
+// Pixel clock, overrides the clock of the board
+#ifdef SMARTDISPLAY_I80_PCLK_HZ
+#undef ST7789_IO_I80_CONFIG_PCLK_HZ
+#define ST7789_IO_I80_CONFIG_PCLK_HZ SMARTDISPLAY_I80_PCLK_HZ
+#endif
+
+// The DMA manager sends chunks of at most the staging buffer, with SMARTDISPLAY_DMA_INFLIGHT_TRANSFERS in flight
+#define I80_MAX_TRANSFER_BYTES LV_MAX(ST7789_I80_BUS_CONFIG_MAX_TRANSFER_BYTES, SMARTDISPLAY_DMA_BUFFER_SIZE)
+#define I80_TRANS_QUEUE_DEPTH LV_MAX(ST7789_IO_I80_CONFIG_TRANS_QUEUE_DEPTH, SMARTDISPLAY_DMA_INFLIGHT_TRANSFERS)
+
+#if ST7789_I80_BUS_CONFIG_BUS_WIDTH == 16
+#ifndef ST7789_I80_BUS_CONFIG_DATA_GPIO_D0
+#error "A 16 bit bus needs ST7789_I80_BUS_CONFIG_DATA_GPIO_D0 to D7, the lines D8 to D15 are the 8 bit bus"
+#endif
+#endif
 
 bool st7789_color_trans_done(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
 {
     // Note: When using DMA, lv_display_flush_ready() is called by DMA callbacks
-    // This callback is only used for direct transfers (non-DMA fallback)
-    lv_display_t *display = user_ctx;
-    // lv_display_flush_ready(display) is handled by DMA callbacks when DMA is enabled.
-    return false;
+    // Every color transfer frees a staging buffer of the DMA manager of the panel
+    const lv_display_t *display = user_ctx;
+    return smartdisplay_dma_trans_done_from_isr(display->user_data);
 }
 
 void st7789_lv_flush(lv_display_t *drv, const lv_area_t *area, uint8_t *px_map)
 {
     // Hardware rotation is supported - use optimized helper function
     const esp_lcd_panel_handle_t panel_handle = drv->user_data;
+#if ST7789_I80_BUS_CONFIG_BUS_WIDTH == 16
+    // A 16 bit bus sends whole pixels, in the byte order of LVGL
+    smartdisplay_dma_flush_no_byteswap(drv, area, px_map, panel_handle, "ST7789 I80");
+#else
     smartdisplay_dma_flush_with_byteswap(drv, area, px_map, panel_handle, "ST7789 I80");
+#endif
 };
 
-lv_display_t *lvgl_lcd_init(uint32_t hor_res, uint32_t ver_res)
+lv_display_t *lvgl_lcd_init(const smartdisplay_config_t *config)
 {
     lv_display_t *display = lv_display_create(DISPLAY_WIDTH, DISPLAY_HEIGHT);
     log_v("display:0x%08x", display);
-    //  Create drawBuffer
-    uint32_t drawBufferSize = sizeof(lv_color_t) * LVGL_BUFFER_PIXELS;
-    void *drawBuffer = heap_caps_malloc(drawBufferSize, LVGL_BUFFER_MALLOC_FLAGS);
-    lv_display_set_buffers(display, drawBuffer, NULL, drawBufferSize, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    //  Create drawBuffer(s)
+    smartdisplay_lcd_set_buffers(display, config);
 
-    pinMode(ST7789_RD, OUTPUT);
-    digitalWrite(ST7789_RD, HIGH);
+    // The panel is never read, RD stays high
+    const gpio_config_t rd_gpio_config = {
+        .pin_bit_mask = BIT64(ST7789_RD),
+        .mode = GPIO_MODE_OUTPUT};
+    ESP_ERROR_CHECK(gpio_config(&rd_gpio_config));
+    ESP_ERROR_CHECK(gpio_set_level(ST7789_RD, 1));
 
     const esp_lcd_i80_bus_config_t i80_bus_config = {
         .clk_src = ST7789_I80_BUS_CONFIG_CLK_SRC,
         .dc_gpio_num = ST7789_I80_BUS_CONFIG_DC,
         .wr_gpio_num = ST7789_I80_BUS_CONFIG_WR,
         .data_gpio_nums = {
+#if ST7789_I80_BUS_CONFIG_BUS_WIDTH == 16
+            ST7789_I80_BUS_CONFIG_DATA_GPIO_D0,
+            ST7789_I80_BUS_CONFIG_DATA_GPIO_D1,
+            ST7789_I80_BUS_CONFIG_DATA_GPIO_D2,
+            ST7789_I80_BUS_CONFIG_DATA_GPIO_D3,
+            ST7789_I80_BUS_CONFIG_DATA_GPIO_D4,
+            ST7789_I80_BUS_CONFIG_DATA_GPIO_D5,
+            ST7789_I80_BUS_CONFIG_DATA_GPIO_D6,
+            ST7789_I80_BUS_CONFIG_DATA_GPIO_D7,
+#endif
             ST7789_I80_BUS_CONFIG_DATA_GPIO_D8,
             ST7789_I80_BUS_CONFIG_DATA_GPIO_D9,
             ST7789_I80_BUS_CONFIG_DATA_GPIO_D10,
@@ -48,8 +82,8 @@ lv_display_t *lvgl_lcd_init(uint32_t hor_res, uint32_t ver_res)
             ST7789_I80_BUS_CONFIG_DATA_GPIO_D14,
             ST7789_I80_BUS_CONFIG_DATA_GPIO_D15},
         .bus_width = ST7789_I80_BUS_CONFIG_BUS_WIDTH,
-        // transfer 100 lines of pixels (assume pixel is RGB565) at most in one transaction
-        .max_transfer_bytes = ST7789_I80_BUS_CONFIG_MAX_TRANSFER_BYTES,
+        // at least a staging buffer of the DMA manager in one transaction
+        .max_transfer_bytes = I80_MAX_TRANSFER_BYTES,
         .psram_trans_align = ST7789_I80_BUS_CONFIG_PSRAM_TRANS_ALIGN,
         .sram_trans_align = ST7789_I80_BUS_CONFIG_SRAM_TRANS_ALIGN};
     log_d("i80_bus_config: clk_src:%d, dc_gpio_num:%d, wr_gpio_num:%d, data_gpio_nums:[%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d], bus_width:%d, max_transfer_bytes:%d, psram_trans_align:%d, sram_trans_align:%d", i80_bus_config.clk_src, i80_bus_config.dc_gpio_num, i80_bus_config.wr_gpio_num, i80_bus_config.data_gpio_nums[0], i80_bus_config.data_gpio_nums[1], i80_bus_config.data_gpio_nums[2], i80_bus_config.data_gpio_nums[3], i80_bus_config.data_gpio_nums[4], i80_bus_config.data_gpio_nums[5], i80_bus_config.data_gpio_nums[6], i80_bus_config.data_gpio_nums[7], i80_bus_config.data_gpio_nums[8], i80_bus_config.data_gpio_nums[9], i80_bus_config.data_gpio_nums[10], i80_bus_config.data_gpio_nums[11], i80_bus_config.data_gpio_nums[12], i80_bus_config.data_gpio_nums[13], i80_bus_config.data_gpio_nums[14], i80_bus_config.data_gpio_nums[15], i80_bus_config.data_gpio_nums[16], i80_bus_config.data_gpio_nums[17], i80_bus_config.data_gpio_nums[18], i80_bus_config.data_gpio_nums[19], i80_bus_config.data_gpio_nums[20], i80_bus_config.data_gpio_nums[21], i80_bus_config.data_gpio_nums[22], i80_bus_config.data_gpio_nums[23], i80_bus_config.bus_width, i80_bus_config.max_transfer_bytes, i80_bus_config.psram_trans_align, i80_bus_config.sram_trans_align);
@@ -62,7 +96,7 @@ lv_display_t *lvgl_lcd_init(uint32_t hor_res, uint32_t ver_res)
         .pclk_hz = ST7789_IO_I80_CONFIG_PCLK_HZ,
         .on_color_trans_done = st7789_color_trans_done,
         .user_ctx = display,
-        .trans_queue_depth = ST7789_IO_I80_CONFIG_TRANS_QUEUE_DEPTH,
+        .trans_queue_depth = I80_TRANS_QUEUE_DEPTH,
         .lcd_cmd_bits = ST7789_IO_I80_CONFIG_LCD_CMD_BITS,
         .lcd_param_bits = ST7789_IO_I80_CONFIG_LCD_PARAM_BITS,
         .dc_levels = {
@@ -89,8 +123,9 @@ lv_display_t *lvgl_lcd_init(uint32_t hor_res, uint32_t ver_res)
     ESP_ERROR_CHECK(esp_lcd_panel_reset(panel_handle));
     ESP_ERROR_CHECK(esp_lcd_panel_init(panel_handle));
     
-    // Initialize DMA for optimized transfers
-    smartdisplay_dma_init_with_logging(panel_handle, "ST7789 I80");
+    // Initialize DMA for optimized transfers, the staging buffers are reused once sent
+    if (smartdisplay_dma_init_with_logging(panel_handle, "ST7789 I80", SMARTDISPLAY_DMA_BOARD_TE_SYNC) == ESP_OK)
+        smartdisplay_dma_track_trans_done(panel_handle);
     
 #ifdef DISPLAY_IPS
     // If LCD is IPS invert the colors
@@ -98,6 +133,10 @@ lv_display_t *lvgl_lcd_init(uint32_t hor_res, uint32_t ver_res)
 #endif
 #if defined(DISPLAY_GAP_X) || defined(DISPLAY_GAP_Y)
     ESP_ERROR_CHECK(esp_lcd_panel_set_gap(panel_handle, DISPLAY_GAP_X, DISPLAY_GAP_Y));
+#endif
+#ifdef DISPLAY_TE
+    // Synchronize the transfers to the refresh of the panel
+    ESP_ERROR_CHECK(lcd_te_enable(io_handle, DISPLAY_TE));
 #endif
     display->user_data = panel_handle;
     display->flush_cb = st7789_lv_flush;
@@ -3,7 +3,7 @@
 #include <esp32_smartdisplay.h>
 #include <driver/spi_master.h>
 #include <esp_lcd_panel_io.h>
-#include <esp_lcd_panel_vendor.h>
+#include <esp_panel_st7789.h>
 #include <esp_lcd_panel_ops.h>
 #include <esp32_smartdisplay_dma_helpers.h>
 
@@ -22,14 +22,12 @@ void st7789_lv_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_m
     smartdisplay_dma_flush_with_byteswap(display, area, px_map, panel_handle, "ST7789 SPI");
 };
 
-lv_display_t *lvgl_lcd_init(uint32_t hor_res, uint32_t ver_res)
+lv_display_t *lvgl_lcd_init(const smartdisplay_config_t *config)
 {
     lv_display_t *display = lv_display_create(DISPLAY_WIDTH, DISPLAY_HEIGHT);
     log_v("display:0x%08x", display);
-    //  Create drawBuffer
-    uint32_t drawBufferSize = sizeof(lv_color_t) * LVGL_BUFFER_PIXELS;
-    void *drawBuffer = heap_caps_malloc(drawBufferSize, LVGL_BUFFER_MALLOC_FLAGS);
-    lv_display_set_buffers(display, drawBuffer, NULL, drawBufferSize, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    //  Create drawBuffer(s)
+    smartdisplay_lcd_set_buffers(display, config);
 
     // Create SPI bus
     const spi_bus_config_t spi_bus_config = {
@@ -67,18 +65,27 @@ lv_display_t *lvgl_lcd_init(uint32_t hor_res, uint32_t ver_res)
     const esp_lcd_panel_dev_config_t panel_dev_config = {
         .reset_gpio_num = ST7789_DEV_CONFIG_RESET,
         .color_space = ST7789_DEV_CONFIG_COLOR_SPACE,
+#ifdef SMARTDISPLAY_RGB444
+        .bits_per_pixel = 12,
+#else
         .bits_per_pixel = ST7789_DEV_CONFIG_BITS_PER_PIXEL,
+#endif
         .flags = {
             .reset_active_high = ST7789_DEV_CONFIG_FLAGS_RESET_ACTIVE_HIGH},
         .vendor_config = ST7789_DEV_CONFIG_VENDOR_CONFIG};
     log_d("panel_dev_config: reset_gpio_num:%d, color_space:%d, bits_per_pixel:%d, flags:{reset_active_high:%d}, vendor_config:0x%08x", panel_dev_config.reset_gpio_num, panel_dev_config.color_space, panel_dev_config.bits_per_pixel, panel_dev_config.flags.reset_active_high, panel_dev_config.vendor_config);
     esp_lcd_panel_handle_t panel_handle;
-    ESP_ERROR_CHECK(esp_lcd_new_panel_st7789(io_handle, &panel_dev_config, &panel_handle));
+    // The DCS engine sets COLMOD from bits_per_pixel, the ESP-IDF driver can not be set to 12 bits per pixel
+    ESP_ERROR_CHECK(esp_lcd_new_panel_st7789_dcs(io_handle, &panel_dev_config, &panel_handle));
     ESP_ERROR_CHECK(esp_lcd_panel_reset(panel_handle));
     ESP_ERROR_CHECK(esp_lcd_panel_init(panel_handle));
     
     // Initialize DMA for optimized transfers
-    smartdisplay_dma_init_with_logging(panel_handle, "ST7789 SPI");
+    smartdisplay_dma_init_with_logging(panel_handle, "ST7789 SPI", SMARTDISPLAY_DMA_BOARD_TE_SYNC);
+#ifdef SMARTDISPLAY_RGB444
+    // The flush packs the pixels to RGB444
+    smartdisplay_dma_set_bits_per_pixel(panel_handle, 12);
+#endif
     
 #ifdef DISPLAY_IPS
     // If LCD is IPS invert the colors
@@ -95,6 +102,10 @@ lv_display_t *lvgl_lcd_init(uint32_t hor_res, uint32_t ver_res)
 #endif
     // Turn display on
     ESP_ERROR_CHECK(esp_lcd_panel_disp_on_off(panel_handle, true));
+#ifdef DISPLAY_TE
+    // Synchronize the transfers to the refresh of the panel
+    ESP_ERROR_CHECK(lcd_te_enable(io_handle, DISPLAY_TE));
+#endif
 
     display->user_data = panel_handle;
     display->flush_cb = st7789_lv_flush;
@@ -23,14 +23,12 @@ void st7796_lv_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_m
     smartdisplay_dma_flush_with_byteswap(display, area, px_map, panel_handle, "ST7796 SPI");
 }
 
-lv_display_t *lvgl_lcd_init(uint32_t hor_res, uint32_t ver_res)
+lv_display_t *lvgl_lcd_init(const smartdisplay_config_t *config)
 {
     lv_display_t *display = lv_display_create(DISPLAY_WIDTH, DISPLAY_HEIGHT);
     log_v("display:0x%08x", display);
-    //  Create drawBuffer
-    uint32_t drawBufferSize = sizeof(lv_color_t) * LVGL_BUFFER_PIXELS;
-    void *drawBuffer = heap_caps_malloc(drawBufferSize, LVGL_BUFFER_MALLOC_FLAGS);
-    lv_display_set_buffers(display, drawBuffer, NULL, drawBufferSize, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    //  Create drawBuffer(s)
+    smartdisplay_lcd_set_buffers(display, config);
 
     // Create SPI bus
     const spi_bus_config_t spi_bus_config = {
@@ -68,7 +66,11 @@ lv_display_t *lvgl_lcd_init(uint32_t hor_res, uint32_t ver_res)
     const esp_lcd_panel_dev_config_t panel_dev_config = {
         .reset_gpio_num = ST7796_DEV_CONFIG_RESET,
         .color_space = ST7796_DEV_CONFIG_COLOR_SPACE,
+#ifdef SMARTDISPLAY_RGB444
+        .bits_per_pixel = 12,
+#else
         .bits_per_pixel = ST7796_DEV_CONFIG_BITS_PER_PIXEL,
+#endif
         .flags = {
             .reset_active_high = ST7796_DEV_CONFIG_FLAGS_RESET_ACTIVE_HIGH},
         .vendor_config = ST7796_DEV_CONFIG_VENDOR_CONFIG};
@@ -79,7 +81,11 @@ lv_display_t *lvgl_lcd_init(uint32_t hor_res, uint32_t ver_res)
     ESP_ERROR_CHECK(esp_lcd_panel_init(panel_handle));
     
     // Initialize DMA for optimized transfers
-    smartdisplay_dma_init_with_logging(panel_handle, "ST7796 SPI");
+    smartdisplay_dma_init_with_logging(panel_handle, "ST7796 SPI", SMARTDISPLAY_DMA_BOARD_TE_SYNC);
+#ifdef SMARTDISPLAY_RGB444
+    // The flush packs the pixels to RGB444
+    smartdisplay_dma_set_bits_per_pixel(panel_handle, 12);
+#endif
     
 #ifdef DISPLAY_IPS
     // If LCD is IPS invert the colors
@@ -96,6 +102,10 @@ lv_display_t *lvgl_lcd_init(uint32_t hor_res, uint32_t ver_res)
 #endif
     // Turn display on
     ESP_ERROR_CHECK(esp_lcd_panel_disp_on_off(panel_handle, true));
+#ifdef DISPLAY_TE
+    // Synchronize the transfers to the refresh of the panel
+    ESP_ERROR_CHECK(lcd_te_enable(io_handle, DISPLAY_TE));
+#endif
 
     display->user_data = panel_handle;
     display->flush_cb = st7796_lv_flush;
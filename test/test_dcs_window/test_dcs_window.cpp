@@ -0,0 +1,180 @@
+// Window caching of the MIPI-DCS panel driver: CASET/RASET are only sent when the window changes.
+// The panel is driven through a fake panel IO that counts the bytes that would go over the bus.
+
+#include <Arduino.h>
+#include <unity.h>
+
+// The panels built with the DCS engine, the same condition as esp_panel_dcs.c
+#if defined(DISPLAY_ILI9341_SPI) || defined(DISPLAY_ST7789_SPI) || defined(DISPLAY_ST7796_SPI) || defined(DISPLAY_GC9A01_SPI) || defined(DISPLAY_AXS15231B_QSPI)
+
+#include <esp_panel_dcs.h>
+#include <esp_lcd_panel_io_interface.h>
+#include <esp_lcd_panel_ops.h>
+#include <esp_lcd_panel_commands.h>
+
+#define TEST_HOR_RES 240
+#define TEST_BAND_ROWS 10
+
+// Command byte and the four coordinate bytes
+#define WINDOW_CMD_BYTES (1 + 4)
+
+static struct
+{
+    esp_lcd_panel_io_t base;
+    size_t bytes;     // Command and parameter/color bytes sent
+    size_t casets;
+    size_t rasets;
+    int fail_cmd;     // Command failing once, -1 for none
+} fake_io;
+
+static esp_err_t fake_io_rx_param(esp_lcd_panel_io_t *io, int lcd_cmd, void *param, size_t param_size)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+static esp_err_t fake_io_tx_param(esp_lcd_panel_io_t *io, int lcd_cmd, const void *param, size_t param_size)
+{
+    if (lcd_cmd == fake_io.fail_cmd)
+    {
+        fake_io.fail_cmd = -1;
+        return ESP_FAIL;
+    }
+
+    fake_io.bytes += 1 + param_size;
+    if (lcd_cmd == LCD_CMD_CASET)
+        fake_io.casets++;
+    if (lcd_cmd == LCD_CMD_RASET)
+        fake_io.rasets++;
+
+    return ESP_OK;
+}
+
+static esp_err_t fake_io_tx_color(esp_lcd_panel_io_t *io, int lcd_cmd, const void *color, size_t color_size)
+{
+    fake_io.bytes += 1 + color_size;
+    return ESP_OK;
+}
+
+static esp_err_t fake_io_del(esp_lcd_panel_io_t *io)
+{
+    return ESP_OK;
+}
+
+static esp_err_t fake_io_register_event_callbacks(esp_lcd_panel_io_t *io, const esp_lcd_panel_io_callbacks_t *cbs, void *user_ctx)
+{
+    return ESP_OK;
+}
+
+static void fake_io_clear()
+{
+    fake_io.bytes = 0;
+    fake_io.casets = 0;
+    fake_io.rasets = 0;
+}
+
+static dcs_panel_descriptor_t descriptor;
+static esp_lcd_panel_handle_t panel;
+static uint16_t pixels[TEST_HOR_RES * TEST_BAND_ROWS];
+
+// Bytes of the RAMWR of a window in RGB565
+static size_t ramwr_bytes(int width, int height)
+{
+    return 1 + width * height * sizeof(uint16_t);
+}
+
+void setUp()
+{
+    fake_io.base.rx_param = fake_io_rx_param;
+    fake_io.base.tx_param = fake_io_tx_param;
+    fake_io.base.tx_color = fake_io_tx_color;
+    fake_io.base.del = fake_io_del;
+    fake_io.base.register_event_callbacks = fake_io_register_event_callbacks;
+    fake_io.fail_cmd = -1;
+    fake_io_clear();
+
+    descriptor = {};
+    descriptor.name = "TEST";
+    descriptor.colmod_rgb565 = 0x55;
+
+    esp_lcd_panel_dev_config_t config = {};
+    config.reset_gpio_num = GPIO_NUM_NC;
+    config.color_space = ESP_LCD_COLOR_SPACE_RGB;
+    config.bits_per_pixel = 16;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_lcd_new_panel_dcs(&descriptor, &fake_io.base, &config, &panel));
+}
+
+void tearDown()
+{
+    esp_lcd_panel_del(panel);
+}
+
+static void test_first_draw_sends_window()
+{
+    TEST_ASSERT_EQUAL(ESP_OK, esp_lcd_panel_draw_bitmap(panel, 0, 0, 10, 10, pixels));
+    TEST_ASSERT_EQUAL(1, fake_io.casets);
+    TEST_ASSERT_EQUAL(1, fake_io.rasets);
+    TEST_ASSERT_EQUAL(2 * WINDOW_CMD_BYTES + ramwr_bytes(10, 10), fake_io.bytes);
+}
+
+static void test_same_window_skips_caset_raset()
+{
+    TEST_ASSERT_EQUAL(ESP_OK, esp_lcd_panel_draw_bitmap(panel, 0, 0, 10, 10, pixels));
+    fake_io_clear();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_lcd_panel_draw_bitmap(panel, 0, 0, 10, 10, pixels));
+    TEST_ASSERT_EQUAL(0, fake_io.casets);
+    TEST_ASSERT_EQUAL(0, fake_io.rasets);
+    TEST_ASSERT_EQUAL(ramwr_bytes(10, 10), fake_io.bytes);
+}
+
+static void test_full_width_bands_skip_caset()
+{
+    // LVGL renders full width bands top down, only the rows change
+    TEST_ASSERT_EQUAL(ESP_OK, esp_lcd_panel_draw_bitmap(panel, 0, 0, TEST_HOR_RES, TEST_BAND_ROWS, pixels));
+    fake_io_clear();
+    for (int y = TEST_BAND_ROWS; y < 4 * TEST_BAND_ROWS; y += TEST_BAND_ROWS)
+        TEST_ASSERT_EQUAL(ESP_OK, esp_lcd_panel_draw_bitmap(panel, 0, y, TEST_HOR_RES, y + TEST_BAND_ROWS, pixels));
+
+    TEST_ASSERT_EQUAL(0, fake_io.casets);
+    TEST_ASSERT_EQUAL(3, fake_io.rasets);
+    TEST_ASSERT_EQUAL(3 * (WINDOW_CMD_BYTES + ramwr_bytes(TEST_HOR_RES, TEST_BAND_ROWS)), fake_io.bytes);
+}
+
+static void test_failed_caset_is_resent()
+{
+    fake_io.fail_cmd = LCD_CMD_CASET;
+    TEST_ASSERT_NOT_EQUAL(ESP_OK, esp_lcd_panel_draw_bitmap(panel, 0, 0, 10, 10, pixels));
+    fake_io_clear();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_lcd_panel_draw_bitmap(panel, 0, 0, 10, 10, pixels));
+    TEST_ASSERT_EQUAL(1, fake_io.casets);
+    TEST_ASSERT_EQUAL(1, fake_io.rasets);
+    TEST_ASSERT_EQUAL(2 * WINDOW_CMD_BYTES + ramwr_bytes(10, 10), fake_io.bytes);
+}
+
+static void test_set_gap_invalidates_window()
+{
+    TEST_ASSERT_EQUAL(ESP_OK, esp_lcd_panel_draw_bitmap(panel, 0, 0, 10, 10, pixels));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_lcd_panel_set_gap(panel, 0, 0));
+    fake_io_clear();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_lcd_panel_draw_bitmap(panel, 0, 0, 10, 10, pixels));
+    TEST_ASSERT_EQUAL(1, fake_io.casets);
+    TEST_ASSERT_EQUAL(1, fake_io.rasets);
+}
+
+#endif
+
+void setup()
+{
+    UNITY_BEGIN();
+#if defined(DISPLAY_ILI9341_SPI) || defined(DISPLAY_ST7789_SPI) || defined(DISPLAY_ST7796_SPI) || defined(DISPLAY_GC9A01_SPI) || defined(DISPLAY_AXS15231B_QSPI)
+    RUN_TEST(test_first_draw_sends_window);
+    RUN_TEST(test_same_window_skips_caset_raset);
+    RUN_TEST(test_full_width_bands_skip_caset);
+    RUN_TEST(test_failed_caset_is_resent);
+    RUN_TEST(test_set_gap_invalidates_window);
+#endif
+    UNITY_END();
+}
+
+void loop()
+{
+}
@@ -1,7 +1,11 @@
+#ifndef PIO_UNIT_TESTING
+
 void setup()
 {
 }
 
 void loop()
 {
-}
\ No newline at end of file
+}
+
+#endif
\ No newline at end of file